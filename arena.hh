@@ -0,0 +1,197 @@
+#ifndef ARENA_HH
+#define ARENA_HH
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+/*Arena przydzielająca pamięć z dużych bloków. Zwolnione fragmenty trafiają
+  na listy wolnych miejsc podzielone na klasy rozmiarów, więc węzły kolejki
+  (wszystkie tego samego rozmiaru) są wielokrotnie używane i leżą obok siebie
+  w pamięci. Cała pamięć jest oddawana systemowi naraz przez release() albo
+  w destruktorze. Arena nie jest bezpieczna wielowątkowo. */
+class PriorityQueueArena {
+public:
+	/*Konstruktor tworzący pustą arenę; bloki będą miały co najmniej size bajtów
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	explicit PriorityQueueArena(std::size_t size = 64 * 1024) noexcept
+		: blocks(nullptr), cursor(nullptr), limit(nullptr), blockSize(size), reservedBytes(0) {
+		for (std::size_t i = 0; i < classes; i++) {
+			freeLists[i] = nullptr;
+		}
+	}
+
+	PriorityQueueArena(const PriorityQueueArena &) = delete;
+	PriorityQueueArena &operator=(const PriorityQueueArena &) = delete;
+
+	/*Desktruktor; zwalnia wszystkie bloki
+	  Exception safety: no-throw */
+	~PriorityQueueArena() {
+		release();
+	}
+
+	/*Metoda przydzielająca bytes bajtów wyrównanych do alignment
+	  Złożoność: O(1) zamortyzowana
+	  Exception safety: strong */
+	void *allocate(std::size_t bytes, std::size_t alignment) {
+		std::size_t cls = sizeClass(bytes, alignment);
+		if (cls < classes) {
+			if (freeLists[cls]) {
+				freeSlot *slot = freeLists[cls];
+				freeLists[cls] = slot->next;
+				return slot;
+			}
+			return bump((cls + 1) * granularity, alignment);
+		}
+		if (bytes > blockSize / 4) {
+			return dedicated(bytes, alignment);
+		}
+		return bump(bytes, alignment);
+	}
+
+	/*Metoda oddająca fragment do ponownego użycia; fragmenty spoza klas
+	  rozmiarów wracają do systemu dopiero w release()
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	void deallocate(void *ptr, std::size_t bytes, std::size_t alignment) noexcept {
+		std::size_t cls = sizeClass(bytes, alignment);
+		if (cls < classes) {
+			freeSlot *slot = static_cast<freeSlot *>(ptr);
+			slot->next = freeLists[cls];
+			freeLists[cls] = slot;
+		}
+	}
+
+	/*Metoda zwracająca liczbę bajtów pobranych od systemu od ostatniego release()
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	std::size_t reserved() const noexcept {
+		return reservedBytes;
+	}
+
+	/*Metoda zwalniająca naraz całą pamięć areny; wcześniej należy zniszczyć
+	  wszystkie korzystające z niej kolejki
+	  Złożoność: O(liczba bloków)
+	  Exception safety: no-throw */
+	void release() noexcept {
+		while (blocks) {
+			block *next = blocks->next;
+			::operator delete(blocks);
+			blocks = next;
+		}
+		cursor = limit = nullptr;
+		reservedBytes = 0;
+		for (std::size_t i = 0; i < classes; i++) {
+			freeLists[i] = nullptr;
+		}
+	}
+
+private:
+	struct block {
+		block *next;
+	};
+
+	struct freeSlot {
+		freeSlot *next;
+	};
+
+	static const std::size_t granularity = alignof(std::max_align_t);
+	static const std::size_t classes = 32;
+
+	block *blocks;
+	char *cursor;
+	char *limit;
+	std::size_t blockSize;
+	std::size_t reservedBytes;
+	freeSlot *freeLists[classes];
+
+	static std::size_t sizeClass(std::size_t bytes, std::size_t alignment) noexcept {
+		if (alignment > granularity || bytes == 0) {
+			return classes;
+		}
+		return (bytes - 1) / granularity;
+	}
+
+	static char *align(char *ptr, std::size_t alignment) noexcept {
+		std::size_t offset = reinterpret_cast<std::size_t>(ptr) % alignment;
+		return offset ? ptr + (alignment - offset) : ptr;
+	}
+
+	char *newBlock(std::size_t bytes) {
+		std::size_t header = (sizeof(block) + granularity - 1) / granularity * granularity;
+		block *b = static_cast<block *>(::operator new(header + bytes));
+		b->next = blocks;
+		blocks = b;
+		reservedBytes += header + bytes;
+		return reinterpret_cast<char *>(b) + header;
+	}
+
+	void *dedicated(std::size_t bytes, std::size_t alignment) {
+		return align(newBlock(bytes + alignment), alignment);
+	}
+
+	void *bump(std::size_t bytes, std::size_t alignment) {
+		char *ptr = cursor ? align(cursor, alignment) : nullptr;
+		if (!ptr || static_cast<std::size_t>(limit - ptr) < bytes) {
+			std::size_t size = blockSize < bytes + alignment ? bytes + alignment : blockSize;
+			char *start = newBlock(size);
+			cursor = start;
+			limit = start + size;
+			ptr = align(cursor, alignment);
+		}
+		cursor = ptr + bytes;
+		return ptr;
+	}
+};
+
+/*Alokator zgodny z std::allocator_traits korzystający z PriorityQueueArena,
+  np. PriorityQueue<K, V, ArenaAllocator<std::pair<const K, V>>> queue(arena);
+  Alokatory są równe wtedy i tylko wtedy, gdy korzystają z tej samej areny. */
+template<typename T>
+class ArenaAllocator {
+public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	ArenaAllocator(PriorityQueueArena &resource) noexcept
+		: arena(&resource) {
+	}
+
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U> &other) noexcept
+		: arena(other.resource()) {
+	}
+
+	T *allocate(std::size_t n) {
+		if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+			throw std::bad_alloc();
+		}
+		return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T *ptr, std::size_t n) noexcept {
+		arena->deallocate(ptr, n * sizeof(T), alignof(T));
+	}
+
+	PriorityQueueArena *resource() const noexcept {
+		return arena;
+	}
+
+private:
+	PriorityQueueArena *arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T> &first, const ArenaAllocator<U> &second) {
+	return first.resource() == second.resource();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &first, const ArenaAllocator<U> &second) {
+	return !(first == second);
+}
+
+#endif //ARENA_HH
@@ -0,0 +1,326 @@
+#ifndef ASYNCQUEUE_HH
+#define ASYNCQUEUE_HH
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+#include <coroutine>
+#define ASYNCQUEUE_COROUTINES 1
+#endif
+
+#include "concurrentqueue.hh"
+
+/*Kolejka ConcurrentPriorityQueue, na której konsumenci mogą czekać na parę:
+  waitPopMin blokuje wątek, a w C++20 co_await popMin() zawiesza korutynę.
+  Czekający stoją w kolejce FIFO i każdy ma własny sygnał, więc wstawienie
+  n par budzi najwyżej n czekających, i to właśnie tych, którym przekazuje
+  zdjęte pary; pozostali śpią dalej, bez budzenia całego stada i bez
+  odpytywania. insert i tryDeleteMin, gdy nikt nie czeka, kosztują tyle co
+  w ConcurrentPriorityQueue plus odczyt jednego licznika. Wstawienie zakresu
+  par budzi czekających naraz, jednym przejściem po ich kolejce. Korutyny są
+  wznawiane w wątku, który wstawił dla nich parę, po zwolnieniu blokad.
+  Kolejka musi żyć dłużej niż czekający na niej konsumenci. */
+template<typename K, typename V, std::size_t Shards = 16, typename Hash = std::hash<K>>
+class AsyncPriorityQueue {
+	/*Czekający konsument: wątek z własnym sygnałem albo zawieszona korutyna.
+	  result ustawia ten, kto przekazuje parę, pod blokadą gate. */
+	struct waiter {
+		PriorityQueueOptional<std::pair<K, V>> result;
+		waiter *prev = nullptr;
+		waiter *next = nullptr;
+		std::condition_variable *signal = nullptr;
+#ifdef ASYNCQUEUE_COROUTINES
+		std::coroutine_handle<> handle;
+#endif
+	};
+
+public:
+	using size_type = std::size_t;
+	using key_type = K;
+	using value_type = V;
+	using pair_type = std::pair<K, V>;
+
+	/*Konstruktor tworzący pustą kolejkę; relaxedMode jak w ConcurrentPriorityQueue
+	  Złożoność: O(Shards)
+	  Exception safety: no-throw */
+	explicit AsyncPriorityQueue(bool relaxedMode = false) noexcept
+		: queue(relaxedMode), waiting(0), head(nullptr), tail(nullptr) {
+	}
+
+	AsyncPriorityQueue(const AsyncPriorityQueue &) = delete;
+	AsyncPriorityQueue &operator=(const AsyncPriorityQueue &) = delete;
+
+	/*Metoda zwracająca true wtedy i tylko wtedy, gdy kolejka jest pusta;
+	  przy współbieżnych modyfikacjach wynik może być od razu nieaktualny
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	bool empty() const noexcept {
+		return queue.empty();
+	}
+
+	/*Metoda zwracająca liczbę par (klucz, wartość) przechowywanych w kolejce
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	size_type size() const noexcept {
+		return queue.size();
+	}
+
+	/*Metoda zwracająca liczbę konsumentów czekających na parę
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	size_type waiters() const noexcept {
+		return waiting.load();
+	}
+
+	/*Metody wstawiające do kolejki parę o kluczu key i wartości value; gdy ktoś
+	  czeka, pierwszy z czekających dostaje parę o najmniejszej wartości
+	  Złożoność: O(log size()), a gdy ktoś czeka, O(Shards + log size())
+	  Exception safety: strong, gdy przeniesienie pary nie zgłasza wyjątków;
+	  w przeciwnym razie basic (para jest wstawiona, ale może być utracona przy
+	  przekazywaniu czekającemu) */
+	void insert(const K &key, const V &value) {
+		queue.insert(key, value);
+		wake();
+	}
+
+	void insert(K &&key, V &&value) {
+		queue.insert(std::move(key), std::move(value));
+		wake();
+	}
+
+	/*Metoda wstawiająca pary z zakresu [first, last) i budząca naraz tylu
+	  czekających, ile par dało się im przekazać
+	  Złożoność: O(n log size()) dla n wstawianych par
+	  Exception safety: basic (pary wstawione przed wyjątkiem zostają w kolejce) */
+	template<typename InputIt>
+	void insert(InputIt first, InputIt last) {
+		try {
+			for (; first != last; ++first) {
+				queue.insert(first->first, first->second);
+			}
+		}
+		catch (...) {
+			wake();
+			throw;
+		}
+		wake();
+	}
+
+	/*Metoda zdejmująca parę jak ConcurrentPriorityQueue::tryDeleteMin, bez czekania
+	  Złożoność: jak ConcurrentPriorityQueue::tryDeleteMin
+	  Exception safety: strong */
+	PriorityQueueOptional<pair_type> tryDeleteMin() {
+		return queue.tryDeleteMin();
+	}
+
+	/*Metoda zdejmująca parę o najmniejszej wartości; gdy kolejka jest pusta,
+	  czeka, aż wstawiona para zostanie przekazana temu wywołaniu
+	  Złożoność: O(Shards + log size()) poza czekaniem
+	  Exception safety: strong */
+	pair_type waitPopMin() {
+		std::condition_variable signal;
+		waiter self;
+		std::unique_lock<std::mutex> guard(gate);
+		if (ready(self, guard)) {
+			return std::move(*self.result);
+		}
+		self.signal = &signal;
+		enqueue(self);
+		signal.wait(guard, [&self]() {
+			return self.result.hasValue();
+		});
+		return std::move(*self.result);
+	}
+
+	/*Metoda zdejmująca parę jak waitPopMin, ale czekająca najwyżej timeout;
+	  zwraca pusty wynik, gdy w tym czasie nie dostała pary
+	  Złożoność: O(Shards + log size()) poza czekaniem
+	  Exception safety: strong */
+	template<typename Rep, typename Period>
+	PriorityQueueOptional<pair_type> waitPopMin(const std::chrono::duration<Rep, Period> &timeout) {
+		const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+			+ std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+		std::condition_variable signal;
+		waiter self;
+		std::unique_lock<std::mutex> guard(gate);
+		if (!ready(self, guard)) {
+			self.signal = &signal;
+			enqueue(self);
+			if (!signal.wait_until(guard, deadline, [&self]() {
+				return self.result.hasValue();
+			})) {
+				dequeue(self);
+			}
+		}
+		return std::move(self.result);
+	}
+
+#ifdef ASYNCQUEUE_COROUTINES
+	/*Obiekt zwracany przez popMin; co_await zwraca zdjętą parę */
+	class pop_awaiter {
+	public:
+		explicit pop_awaiter(AsyncPriorityQueue &queue) noexcept : owner(queue) {
+		}
+
+		bool await_ready() const noexcept {
+			return false;
+		}
+
+		/*Zdejmuje parę od razu, jeśli jest, a w przeciwnym razie zapisuje
+		  się w kolejce czekających; po zwolnieniu blokady korutyna może
+		  zostać wznowiona przez inny wątek, więc obiekt nie jest już używany */
+		bool await_suspend(std::coroutine_handle<> handle) {
+			std::unique_lock<std::mutex> guard(owner.gate);
+			if (owner.ready(self, guard)) {
+				return false;
+			}
+			self.handle = handle;
+			owner.enqueue(self);
+			return true;
+		}
+
+		pair_type await_resume() {
+			return std::move(*self.result);
+		}
+
+	private:
+		AsyncPriorityQueue &owner;
+		waiter self;
+	};
+
+	/*Metoda zwracająca obiekt, na którym korutyna czeka przez co_await na parę
+	  o najmniejszej wartości, jak waitPopMin, ale bez blokowania wątku
+	  Złożoność: O(Shards + log size()) poza czekaniem
+	  Exception safety: strong */
+	pop_awaiter popMin() noexcept {
+		return pop_awaiter(*this);
+	}
+#endif
+
+	/*Metody zmieniające wartość przypisaną kluczowi key jak w ConcurrentPriorityQueue
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	void changeValue(const K &key, const V &value) {
+		queue.changeValue(key, value);
+	}
+
+	bool tryChangeValue(const K &key, const V &value) {
+		return queue.tryChangeValue(key, value);
+	}
+
+private:
+	ConcurrentPriorityQueue<K, V, Shards, Hash> queue;
+	std::mutex gate;
+	/*Liczba zapisanych i zapisujących się czekających; insert zagląda pod
+	  gate tylko wtedy, gdy jest dodatnia */
+	std::atomic<size_type> waiting;
+	waiter *head;
+	waiter *tail;
+
+	/*Próbuje zdjąć parę dla self pod blokadą gate. Licznik jest zwiększany
+	  przed próbą: jeśli kolejka okaże się pusta, to każdy insert, którego para
+	  tego nie zmieniła, zobaczy już dodatni licznik i poczeka na gate, aż self
+	  zapisze się w kolejce czekających. */
+	bool ready(waiter &self, std::unique_lock<std::mutex> &) {
+		waiting.fetch_add(1);
+		try {
+			self.result = queue.tryDeleteMin();
+		}
+		catch (...) {
+			waiting.fetch_sub(1);
+			throw;
+		}
+		if (self.result) {
+			waiting.fetch_sub(1);
+			return true;
+		}
+		return false;
+	}
+
+	void enqueue(waiter &self) noexcept {
+		self.prev = tail;
+		self.next = nullptr;
+		if (tail) {
+			tail->next = &self;
+		}
+		else {
+			head = &self;
+		}
+		tail = &self;
+	}
+
+	void dequeue(waiter &self) noexcept {
+		if (self.prev) {
+			self.prev->next = self.next;
+		}
+		else {
+			head = self.next;
+		}
+		if (self.next) {
+			self.next->prev = self.prev;
+		}
+		else {
+			tail = self.prev;
+		}
+		waiting.fetch_sub(1);
+	}
+
+	/*Przekazuje pary kolejnym czekającym, dopóki są pary i czekający. Wątki są
+	  budzone pod blokadą, bo po jej zwolnieniu czekający z limitem czasu może
+	  już nie istnieć; korutyny są wznawiane po jej zwolnieniu, także wtedy,
+	  gdy przekazanie kolejnej pary zgłosi wyjątek. */
+	void wake() {
+		if (waiting.load() == 0) {
+			return;
+		}
+#ifdef ASYNCQUEUE_COROUTINES
+		waiter *resumed = nullptr;
+		waiter *resumedTail = nullptr;
+		std::exception_ptr failure;
+		try {
+#endif
+			std::lock_guard<std::mutex> guard(gate);
+			while (head) {
+				PriorityQueueOptional<pair_type> taken = queue.tryDeleteMin();
+				if (!taken) {
+					break;
+				}
+				waiter &w = *head;
+				w.result = std::move(taken);
+				dequeue(w);
+				if (w.signal) {
+					w.signal->notify_one();
+				}
+#ifdef ASYNCQUEUE_COROUTINES
+				else {
+					w.next = nullptr;
+					(resumedTail ? resumedTail->next : resumed) = &w;
+					resumedTail = &w;
+				}
+#endif
+			}
+#ifdef ASYNCQUEUE_COROUTINES
+		}
+		catch (...) {
+			failure = std::current_exception();
+		}
+		while (resumed) {
+			waiter &w = *resumed;
+			resumed = w.next;
+			w.handle.resume();
+		}
+		if (failure) {
+			std::rethrow_exception(failure);
+		}
+#endif
+	}
+};
+
+#endif //ASYNCQUEUE_HH
@@ -0,0 +1,226 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "priorityqueue.hh"
+
+/*Mikrobenchmarki PriorityQueue. Każda kombinacja typu i rozmiaru jest
+  mierzona w osobnym procesie, więc szczytowe RSS dotyczy tylko jej.
+  Dane są generowane ze stałego ziarna, więc kolejne uruchomienia mierzą
+  te same operacje. Użycie: ./bench [największy rozmiar] (domyślnie 1e7) */
+
+static std::size_t allocations = 0;
+
+// GCC po wstawieniu operatorów w miejsce wywołania błędnie zgłasza
+// niezgodność malloc i delete
+#ifdef __GNUC__
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void *operator new(std::size_t size) {
+	allocations++;
+	if (void *ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+BENCH_NOINLINE void operator delete(void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+struct Pod64 {
+	char data[64];
+
+	bool operator<(const Pod64 &other) const {
+		return std::memcmp(data, other.data, sizeof(data)) < 0;
+	}
+
+	bool operator==(const Pod64 &other) const {
+		return std::memcmp(data, other.data, sizeof(data)) == 0;
+	}
+};
+
+template<typename T>
+T make(std::mt19937_64 &engine);
+
+template<>
+int make<int>(std::mt19937_64 &engine) {
+	return static_cast<int>(engine());
+}
+
+template<>
+Pod64 make<Pod64>(std::mt19937_64 &engine) {
+	Pod64 result;
+	for (std::size_t i = 0; i < sizeof(result.data); i += sizeof(std::uint64_t)) {
+		std::uint64_t r = engine();
+		std::memcpy(result.data + i, &r, sizeof(r));
+	}
+	return result;
+}
+
+template<>
+std::string make<std::string>(std::mt19937_64 &engine) {
+	// dłuższe niż bufor małych napisów, żeby każdy napis był alokowany
+	std::string result(32, 'a');
+	for (char &c : result) {
+		c = static_cast<char>('a' + engine() % 26);
+	}
+	return result;
+}
+
+static void report(const char *type, std::size_t n, const char *op,
+                   double nanoseconds, std::size_t allocs, std::size_t ops) {
+	std::printf("%-8s %9zu %-12s %12.1f %10.3f\n", type, n, op, nanoseconds / ops,
+	            static_cast<double>(allocs) / ops);
+}
+
+/*Mierzy body wykonywane reps razy; setup (niemierzony) przygotowuje każde
+  powtórzenie, body zwraca liczbę wykonanych operacji */
+template<typename Setup, typename Body>
+static void measure(const char *type, std::size_t n, const char *op, std::size_t reps, Setup setup, Body body) {
+	double nanoseconds = 0;
+	std::size_t allocs = 0;
+	std::size_t ops = 0;
+	for (std::size_t r = 0; r < reps; r++) {
+		setup();
+		std::size_t before = allocations;
+		auto start = std::chrono::steady_clock::now();
+		ops += body();
+		auto stop = std::chrono::steady_clock::now();
+		allocs += allocations - before;
+		nanoseconds += std::chrono::duration<double, std::nano>(stop - start).count();
+	}
+	report(type, n, op, nanoseconds, allocs, ops ? ops : 1);
+}
+
+template<typename T>
+static void run(const char *type, std::size_t n) {
+	using Queue = PriorityQueue<T, T>;
+	std::mt19937_64 engine(n);
+	std::vector<T> keys, values;
+	keys.reserve(n);
+	values.reserve(n);
+	for (std::size_t i = 0; i < n; i++) {
+		keys.push_back(make<T>(engine));
+		values.push_back(make<T>(engine));
+	}
+	std::size_t changes = n < 100000 ? n : 100000;
+	std::vector<std::size_t> targets;
+	std::vector<T> replacements;
+	for (std::size_t i = 0; i < changes; i++) {
+		targets.push_back(engine() % n);
+		replacements.push_back(make<T>(engine));
+	}
+	std::size_t reps = n < 1000000 ? 1000000 / n : 1;
+
+	Queue base;
+	for (std::size_t i = 0; i < n; i++) {
+		base.insert(keys[i], values[i]);
+	}
+	Queue work;
+
+	measure(type, n, "insert", reps, [&]() { work = Queue(); }, [&]() {
+		for (std::size_t i = 0; i < n; i++) {
+			work.insert(keys[i], values[i]);
+		}
+		return n;
+	});
+	volatile std::size_t peeked = 0;
+	measure(type, n, "minValue", reps, []() {}, [&]() {
+		for (std::size_t i = 0; i < n; i++) {
+			peeked = peeked + (&base.minValue() != nullptr);
+		}
+		return n;
+	});
+	measure(type, n, "deleteMin", reps, [&]() { work = base; }, [&]() {
+		for (std::size_t i = 0; i < n; i++) {
+			work.deleteMin();
+		}
+		return n;
+	});
+	measure(type, n, "deleteMax", reps, [&]() { work = base; }, [&]() {
+		for (std::size_t i = 0; i < n; i++) {
+			work.deleteMax();
+		}
+		return n;
+	});
+	measure(type, n, "changeValue", reps, [&]() { work = base; }, [&]() {
+		for (std::size_t i = 0; i < changes; i++) {
+			work.changeValue(keys[targets[i]], replacements[i]);
+		}
+		return changes;
+	});
+
+	Queue left, right;
+	measure(type, n, "merge", reps, [&]() {
+		left = Queue();
+		right = Queue();
+		for (std::size_t i = 0; i < n; i++) {
+			(i % 2 ? left : right).insert(keys[i], values[i]);
+		}
+	}, [&]() {
+		left.merge(right);
+		return n;
+	});
+	measure(type, n, "copy", reps, [&]() { work = Queue(); }, [&]() {
+		Queue copy(base);
+		work.swap(copy);
+		return n;
+	});
+
+	Queue same(base);
+	volatile bool sink = false;
+	measure(type, n, "operator==", reps, []() {}, [&]() {
+		sink = base == same;
+		return n;
+	});
+	measure(type, n, "operator<", reps, []() {}, [&]() {
+		sink = base < same;
+		return n;
+	});
+	(void) sink;
+	(void) peeked;
+
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	std::printf("%-8s %9zu %-12s %12ld KiB\n", type, n, "peak RSS", usage.ru_maxrss);
+}
+
+template<typename T>
+static void sweep(const char *type, std::size_t limit) {
+	for (std::size_t n = 100; n <= limit; n *= 10) {
+		std::fflush(stdout);
+		pid_t child = fork();
+		if (child == 0) {
+			run<T>(type, n);
+			std::fflush(stdout);
+			_exit(0);
+		}
+		int status;
+		waitpid(child, &status, 0);
+	}
+}
+
+int main(int argc, char **argv) {
+	std::size_t limit = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+	std::printf("%-8s %9s %-12s %12s %10s\n", "type", "size", "operation", "ns/op", "allocs/op");
+	sweep<int>("int", limit);
+	sweep<Pod64>("pod64", limit);
+	sweep<std::string>("string", limit);
+}
@@ -0,0 +1,299 @@
+#ifndef CONCURRENTQUEUE_HH
+#define CONCURRENTQUEUE_HH
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+
+#include "priorityqueue.hh"
+
+/*Kolejka priorytetowa współdzielona przez wiele wątków. Pary są rozdzielone
+  między Shards kolejek PriorityQueue według skrótu klucza, a każda z nich ma
+  własny mutex, więc insert, changeValue i operacje na różnych kluczach nie
+  blokują się nawzajem. Operacje na wartości najmniejszej i największej
+  w trybie dokładnym blokują wszystkie części; w trybie zrelaksowanym (relaxed
+  w konstruktorze) deleteMin i deleteMax wybierają lepszą z dwóch losowych
+  części (MultiQueue), więc zdjęta para jest bliska skrajnej, ale nie zawsze
+  skrajna. Metody zwracają kopie, bo referencje do elementów byłyby
+  unieważniane przez inne wątki. */
+template<typename K, typename V, std::size_t Shards = 16, typename Hash = std::hash<K>>
+class ConcurrentPriorityQueue {
+	static_assert(Shards > 0, "ConcurrentPriorityQueue needs at least one shard");
+
+public:
+	using size_type = std::size_t;
+	using key_type = K;
+	using value_type = V;
+
+	/*Konstruktor tworzący pustą kolejkę
+	  Złożoność: O(Shards)
+	  Exception safety: no-throw */
+	explicit ConcurrentPriorityQueue(bool relaxedMode = false) noexcept
+		: relaxed(relaxedMode), elements(0) {
+	}
+
+	ConcurrentPriorityQueue(const ConcurrentPriorityQueue &) = delete;
+	ConcurrentPriorityQueue &operator=(const ConcurrentPriorityQueue &) = delete;
+
+	/*Metoda zwracająca true wtedy i tylko wtedy, gdy kolejka jest pusta;
+	  przy współbieżnych modyfikacjach wynik może być od razu nieaktualny
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	bool empty() const noexcept {
+		return size() == 0;
+	}
+
+	/*Metoda zwracająca liczbę par (klucz, wartość) przechowywanych w kolejce
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	size_type size() const noexcept {
+		return elements.load(std::memory_order_relaxed);
+	}
+
+	/*Metoda wstawiająca do kolejki parę o kluczu key i wartości value
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	void insert(const K &key, const V &value) {
+		shard &s = shardOf(key);
+		std::lock_guard<std::mutex> guard(s.lock);
+		s.queue.insert(key, value);
+		elements.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/*Metoda wstawiająca do kolejki parę, przenosząc key i value
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	void insert(K &&key, V &&value) {
+		shard &s = shardOf(key);
+		std::lock_guard<std::mutex> guard(s.lock);
+		s.queue.insert(std::move(key), std::move(value));
+		elements.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/*Metody zwracające kopię najmniejszej i największej wartości oraz klucza
+	  przypisanego do tej wartości; rzucają PriorityQueueEmptyException dla pustej kolejki
+	  Złożoność: O(Shards)
+	  Exception safety: strong */
+	V minValue() const {
+		lockAll guard(*this);
+		return self().extreme(true).minValue();
+	}
+
+	V maxValue() const {
+		lockAll guard(*this);
+		return self().extreme(false).maxValue();
+	}
+
+	K minKey() const {
+		lockAll guard(*this);
+		return self().extreme(true).minKey();
+	}
+
+	K maxKey() const {
+		lockAll guard(*this);
+		return self().extreme(false).maxKey();
+	}
+
+	/*Metody usuwające z kolejki jedną parę o najmniejszej albo największej
+	  wartości (w trybie zrelaksowanym: bliskiej skrajnej); dla pustej kolejki nic nie robią
+	  Złożoność: O(Shards + log size()), w trybie zrelaksowanym O(log size())
+	  Exception safety: strong */
+	void deleteMin() {
+		pop(true);
+	}
+
+	void deleteMax() {
+		pop(false);
+	}
+
+	/*Metody zdejmujące z kolejki parę jak deleteMin i deleteMax i zwracające ją;
+	  zwracają pusty wynik zamiast rzucać wyjątek, gdy kolejka jest pusta
+	  Złożoność: O(Shards + log size()), w trybie zrelaksowanym O(log size())
+	  Exception safety: strong */
+	PriorityQueueOptional<std::pair<K, V>> tryDeleteMin() {
+		return pop(true);
+	}
+
+	PriorityQueueOptional<std::pair<K, V>> tryDeleteMax() {
+		return pop(false);
+	}
+
+	/*Metoda zmieniająca dotychczasową wartość przypisaną kluczowi key na nową wartość value;
+	  rzuca PriorityQueueNotFoundException, gdy klucza nie ma w kolejce
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	void changeValue(const K &key, const V &value) {
+		shard &s = shardOf(key);
+		std::lock_guard<std::mutex> guard(s.lock);
+		s.queue.changeValue(key, value);
+	}
+
+	/*Metoda zmieniająca wartość przypisaną kluczowi key jak changeValue;
+	  zwraca false, nic nie zmieniając, gdy klucza nie ma w kolejce
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	bool tryChangeValue(const K &key, const V &value) {
+		shard &s = shardOf(key);
+		std::lock_guard<std::mutex> guard(s.lock);
+		return s.queue.tryChangeValue(key, value);
+	}
+
+	/*Metoda scalająca zawartość kolejki z podaną kolejką queue; ta operacja usuwa
+	  wszystkie elementy z kolejki queue i wstawia je do kolejki *this
+	  Złożoność: O(size() + queue.size())
+	  Exception safety: basic (części scalone przed wyjątkiem pozostają scalone) */
+	void merge(ConcurrentPriorityQueue &queue) {
+		if (this == &queue) {
+			return;
+		}
+		lockBoth guard(*this, queue);
+		for (std::size_t i = 0; i < Shards; i++) {
+			std::size_t moved = queue.shards[i].queue.size();
+			shards[i].queue.merge(queue.shards[i].queue);
+			queue.elements.fetch_sub(moved, std::memory_order_relaxed);
+			elements.fetch_add(moved, std::memory_order_relaxed);
+		}
+	}
+
+	/*Metoda zamieniająca zawartość kolejki z podaną kolejką queue
+	  Złożoność: O(Shards)
+	  Exception safety: no-throw */
+	void swap(ConcurrentPriorityQueue &queue) noexcept {
+		if (this == &queue) {
+			return;
+		}
+		lockBoth guard(*this, queue);
+		for (std::size_t i = 0; i < Shards; i++) {
+			shards[i].queue.swap(queue.shards[i].queue);
+		}
+		std::size_t mine = elements.load(std::memory_order_relaxed);
+		elements.store(queue.elements.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		queue.elements.store(mine, std::memory_order_relaxed);
+	}
+
+private:
+	struct shard {
+		std::mutex lock;
+		PriorityQueue<K, V> queue;
+	};
+
+	/*Blokuje wszystkie części kolejki, zawsze w tej samej kolejności */
+	class lockAll {
+	public:
+		explicit lockAll(const ConcurrentPriorityQueue &queue) noexcept : target(queue.self()) {
+			for (std::size_t i = 0; i < Shards; i++) {
+				target.shards[i].lock.lock();
+			}
+		}
+
+		lockAll(const lockAll &) = delete;
+		lockAll &operator=(const lockAll &) = delete;
+
+		~lockAll() {
+			for (std::size_t i = Shards; i > 0; i--) {
+				target.shards[i - 1].lock.unlock();
+			}
+		}
+
+	private:
+		ConcurrentPriorityQueue &target;
+	};
+
+	static bool ordered(ConcurrentPriorityQueue &first, ConcurrentPriorityQueue &second) noexcept {
+		return std::less<ConcurrentPriorityQueue *>()(&first, &second);
+	}
+
+	/*Blokuje dwie kolejki w kolejności adresów, żeby uniknąć zakleszczenia */
+	class lockBoth {
+	public:
+		lockBoth(ConcurrentPriorityQueue &first, ConcurrentPriorityQueue &second) noexcept
+			: lower(ordered(first, second) ? first : second),
+			  upper(ordered(first, second) ? second : first) {
+		}
+
+	private:
+		lockAll lower;
+		lockAll upper;
+	};
+
+	shard shards[Shards];
+	bool relaxed;
+	std::atomic<std::size_t> elements;
+
+	ConcurrentPriorityQueue &self() const noexcept {
+		return const_cast<ConcurrentPriorityQueue &>(*this);
+	}
+
+	shard &shardOf(const K &key) {
+		return shards[Hash()(key) % Shards];
+	}
+
+	/*Zwraca część z najmniejszą albo największą wartością; wymaga zablokowania
+	  wszystkich części. Dla pustej kolejki zwraca pustą część, której metody
+	  rzucą PriorityQueueEmptyException. */
+	PriorityQueue<K, V> &extreme(bool fromMin) {
+		shard *best = nullptr;
+		for (std::size_t i = 0; i < Shards; i++) {
+			if (!shards[i].queue.empty() && (!best || better(shards[i], *best, fromMin))) {
+				best = &shards[i];
+			}
+		}
+		return best ? best->queue : shards[0].queue;
+	}
+
+	static bool better(shard &candidate, shard &current, bool fromMin) {
+		return fromMin ? candidate.queue.minValue() < current.queue.minValue()
+		               : current.queue.maxValue() < candidate.queue.maxValue();
+	}
+
+	static std::size_t randomShard() {
+		static thread_local std::minstd_rand engine(
+			static_cast<std::minstd_rand::result_type>(std::hash<std::thread::id>()(std::this_thread::get_id())));
+		return engine() % Shards;
+	}
+
+	/*Zdejmuje skrajną parę z części q, która musi być zablokowana */
+	PriorityQueueOptional<std::pair<K, V>> take(PriorityQueue<K, V> &q, bool fromMin) {
+		PriorityQueueOptional<std::pair<K, V>> result = fromMin ? q.tryPopMin() : q.tryPopMax();
+		if (result) {
+			elements.fetch_sub(1, std::memory_order_relaxed);
+		}
+		return result;
+	}
+
+	PriorityQueueOptional<std::pair<K, V>> pop(bool fromMin) {
+		if (relaxed && Shards > 1) {
+			std::size_t a = randomShard();
+			std::size_t b = randomShard();
+			if (a != b) {
+				std::unique_lock<std::mutex> first(shards[a < b ? a : b].lock);
+				std::unique_lock<std::mutex> second(shards[a < b ? b : a].lock);
+				shard *best = nullptr;
+				for (shard *s : {&shards[a], &shards[b]}) {
+					if (!s->queue.empty() && (!best || better(*s, *best, fromMin))) {
+						best = s;
+					}
+				}
+				if (best) {
+					return take(best->queue, fromMin);
+				}
+			}
+		}
+		// obie wylosowane części były puste: dokładne wyszukiwanie, żeby pusty
+		// wynik oznaczał, że cała kolejka była w pewnej chwili pusta
+		lockAll guard(*this);
+		return take(extreme(fromMin), fromMin);
+	}
+};
+
+template<typename K, typename V, std::size_t Shards, typename Hash>
+void swap(ConcurrentPriorityQueue<K, V, Shards, Hash> &first,
+          ConcurrentPriorityQueue<K, V, Shards, Hash> &second) noexcept {
+	first.swap(second);
+}
+
+#endif //CONCURRENTQUEUE_HH
@@ -0,0 +1,267 @@
+#ifndef DEFERREDQUEUE_HH
+#define DEFERREDQUEUE_HH
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+/*Kolejka priorytetowa z leniwym trybem dla serii modyfikacji. insert,
+  erase(key) i changeValue nie przebudowują drzew: wstawiane pary trafiają do
+  nieposortowanego bufora, usunięcie par już uporządkowanych zostawia nagrobek
+  klucza, a zmiana wartości jedynej uporządkowanej pary o danym kluczu jest
+  zapamiętywana. Bufor jest scalany z uporządkowaną kolejką naraz (flush), dopiero
+  gdy potrzebny jest porządek: przez minValue, maxValue, deleteMin i pozostałe
+  operacje na skrajnych parach. Wiele zmian tego samego klucza w jednej serii
+  kosztuje więc O(1) każda i jedną operację na drzewach przy scalaniu.
+  Wymaga haszu Hash i operatora == dla kluczy, zgodnego z <. Metody stałe
+  mogą scalać bufor, więc obiekt, jak PriorityQueue, nie może być używany
+  z wielu wątków naraz. */
+template<typename K, typename V, typename Hash = std::hash<K>>
+class DeferredPriorityQueue {
+public:
+	using size_type = std::size_t;
+	using key_type = K;
+	using value_type = V;
+	using queue_type = PriorityQueue<K, V, std::allocator<std::pair<const K, V>>, PriorityQueueHashLookup<Hash>>;
+
+	/*Konstruktor tworzący pustą kolejkę
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	DeferredPriorityQueue() = default;
+
+	/*Metoda zwracająca true wtedy i tylko wtedy, gdy kolejka jest pusta
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	bool empty() const noexcept {
+		return size() == 0;
+	}
+
+	/*Metoda zwracająca liczbę par (klucz, wartość), łącznie z buforem
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	size_type size() const noexcept {
+		return settled.size() - buried + buffered;
+	}
+
+	/*Metoda zwracająca liczbę par czekających w buforze na scalenie
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	size_type pending() const noexcept {
+		return buffered;
+	}
+
+	/*Metoda dopisująca do bufora parę o kluczu key i wartości value
+	  Złożoność: O(1) średnio
+	  Exception safety: strong */
+	void insert(const K &key, const V &value) {
+		entries[key].added.push_back(value);
+		buffered++;
+	}
+
+	/*Metoda usuwająca wszystkie pary o kluczu key; pary uporządkowane są
+	  usuwane przy scaleniu. Zwraca liczbę usuniętych par.
+	  Złożoność: O(1 + wynik) średnio
+	  Exception safety: strong */
+	size_type erase(const K &key) {
+		auto it = entries.find(key);
+		size_type live = settledCount(key, it);
+		size_type removed = live + (it == entries.end() ? 0 : it->second.added.size());
+		if (removed == 0) {
+			return 0;
+		}
+		if (it == entries.end()) {
+			it = entries.emplace(key, entry()).first;
+		}
+		entry &e = it->second;
+		buffered -= e.added.size();
+		e.added.clear();
+		e.change.reset();
+		if (live) {
+			e.erased = true;
+			buried += live;
+		}
+		return removed;
+	}
+
+	/*Metoda zmieniająca wartość pary o kluczu key jak PriorityQueue::changeValue;
+	  rzuca PriorityQueueNotFoundException, gdy klucza nie ma w kolejce. Gdy
+	  para o tym kluczu jest jedna, zmiana nie dotyka drzew do scalenia;
+	  w przeciwnym razie, jeśli para o najmniejszej wartości nie jest
+	  jednoznacznie w buforze, kolejka jest najpierw scalana.
+	  Złożoność: O(1 + liczba par z kluczem key w buforze) średnio,
+	  a O(log size()) po scaleniu
+	  Exception safety: strong */
+	void changeValue(const K &key, const V &value) {
+		if (!tryChangeValue(key, value)) {
+			throw PriorityQueueNotFoundException();
+		}
+	}
+
+	/*Metoda zmieniająca wartość jak changeValue; zwraca false, nic nie
+	  zmieniając, gdy klucza nie ma w kolejce
+	  Złożoność: jak changeValue
+	  Exception safety: jak changeValue */
+	bool tryChangeValue(const K &key, const V &value) {
+		auto it = entries.find(key);
+		size_type live = settledCount(key, it);
+		if (it != entries.end() && !it->second.added.empty()) {
+			if (live) {
+				flush();
+				return settled.tryChangeValue(key, value);
+			}
+			std::vector<V> &added = it->second.added;
+			auto smallest = added.begin();
+			for (auto x = added.begin(); x != added.end(); ++x) {
+				if (*x < *smallest) {
+					smallest = x;
+				}
+			}
+			*smallest = value;
+			return true;
+		}
+		if (live == 0) {
+			return false;
+		}
+		if (live > 1) {
+			flush();
+			return settled.tryChangeValue(key, value);
+		}
+		if (it == entries.end()) {
+			it = entries.emplace(key, entry()).first;
+		}
+		it->second.change.emplace(value);
+		return true;
+	}
+
+	/*Metoda zwracająca true wtedy i tylko wtedy, gdy w kolejce jest para o kluczu key
+	  Złożoność: O(1) średnio
+	  Exception safety: strong */
+	bool contains(const K &key) const {
+		return count(key) > 0;
+	}
+
+	/*Metoda zwracająca liczbę par o kluczu key
+	  Złożoność: O(1 + wynik) średnio
+	  Exception safety: strong */
+	size_type count(const K &key) const {
+		auto it = entries.find(key);
+		return settledCount(key, it) + (it == entries.end() ? 0 : it->second.added.size());
+	}
+
+	/*Metody zwracające skrajne wartości i ich klucze; scalają bufor i rzucają
+	  PriorityQueueEmptyException dla pustej kolejki
+	  Złożoność: O(1), a wraz ze scaleniem O(m log m + size()) dla m zmian w buforze
+	  Exception safety: strong (zawartość kolejki się nie zmienia, nawet gdy
+	  scalenie zostanie przerwane) */
+	const V &minValue() const {
+		return ordered().minValue();
+	}
+
+	const V &maxValue() const {
+		return ordered().maxValue();
+	}
+
+	const K &minKey() const {
+		return ordered().minKey();
+	}
+
+	const K &maxKey() const {
+		return ordered().maxKey();
+	}
+
+	/*Metody usuwające parę o najmniejszej albo największej wartości; scalają bufor
+	  Złożoność: O(log size()), a wraz ze scaleniem O(m log m + size())
+	  Exception safety: strong */
+	void deleteMin() {
+		ordered().deleteMin();
+	}
+
+	void deleteMax() {
+		ordered().deleteMax();
+	}
+
+	PriorityQueueOptional<std::pair<K, V>> tryPopMin() {
+		return ordered().tryPopMin();
+	}
+
+	PriorityQueueOptional<std::pair<K, V>> tryPopMax() {
+		return ordered().tryPopMax();
+	}
+
+	/*Metoda zwracająca uporządkowaną kolejkę po scaleniu bufora, np. do
+	  iterowania; referencja jest ważna do następnej modyfikacji
+	  Złożoność: O(1), a wraz ze scaleniem O(m log m + size())
+	  Exception safety: strong */
+	const queue_type &queue() const {
+		return ordered();
+	}
+
+	/*Metoda scalająca bufor z uporządkowaną kolejką: najpierw są wykonywane
+	  zapamiętane usunięcia i zmiany wartości, a potem nowe pary są sortowane
+	  i scalane naraz. Zastosowane zmiany znikają z bufora od razu, więc po
+	  wyjątku zawartość kolejki jest taka sama, a w buforze zostaje reszta.
+	  Złożoność: O(m log m + size()) dla m zmian w buforze
+	  Exception safety: strong */
+	void flush() const {
+		if (entries.empty()) {
+			return;
+		}
+		std::vector<std::pair<K, V>> added;
+		added.reserve(buffered);
+		for (auto &kv : entries) {
+			entry &e = kv.second;
+			if (e.erased) {
+				size_type removed = settled.erase(kv.first);
+				e.erased = false;
+				buried -= removed;
+			}
+			if (e.change) {
+				settled.changeValue(kv.first, *e.change);
+				e.change.reset();
+			}
+			for (const V &value : e.added) {
+				added.emplace_back(kv.first, value);
+			}
+		}
+		settled.insert(added.begin(), added.end());
+		entries.clear();
+		buffered = 0;
+	}
+
+private:
+	/*Oczekujące zmiany jednego klucza. erased oznacza nagrobek: uporządkowane
+	  pary o tym kluczu są już usunięte z kolejki. change to nowa wartość
+	  jedynej uporządkowanej pary o tym kluczu. */
+	struct entry {
+		std::vector<V> added;
+		bool erased = false;
+		PriorityQueueOptional<V> change;
+	};
+
+	using entry_map = std::unordered_map<K, entry, Hash>;
+
+	mutable queue_type settled;
+	mutable entry_map entries;
+	mutable size_type buffered = 0;
+	mutable size_type buried = 0;
+
+	/*Liczba uporządkowanych par o kluczu key, które nie są pod nagrobkiem */
+	size_type settledCount(const K &key, typename entry_map::const_iterator it) const {
+		if (it != entries.end() && it->second.erased) {
+			return 0;
+		}
+		return settled.count(key);
+	}
+
+	queue_type &ordered() const {
+		flush();
+		return settled;
+	}
+};
+
+#endif //DEFERREDQUEUE_HH
@@ -0,0 +1,746 @@
+#ifndef FLATQUEUE_HH
+#define FLATQUEUE_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+/*Kolejka o tym samym interfejsie co PriorityQueue<K, V>, przeznaczona dla
+  kolejek budowanych raz i potem głównie odczytywanych. Klucze i wartości są
+  trzymane w dwóch osobnych, ciągłych tablicach posortowanych w porządku
+  (klucz, wartość), a porządek (wartość, klucz) to tablica indeksów do nich.
+  Odczyt skrajnych par kosztuje O(1), wyszukiwanie klucza to wyszukiwanie
+  binarne bez rozgałęzień po tablicy samych kluczy, a przejście po porządku
+  kluczy i porównania kolejek to przejścia po ciągłej pamięci. Modyfikacje
+  pojedynczych par są liniowe; wstawienie zakresu i merge scalają tablice
+  naraz. Kolejkę drzewiastą zamienia się na tę przez freeze(queue).
+  TieBreak rozstrzyga pary o równych wartościach jak w PriorityQueue:
+  z PriorityQueueFifoTieBreak kolejność wstawienia wyznacza pozycja w tablicach,
+  więc pary nie potrzebują numerów.
+
+  Modyfikacje najpierw wykonują wszystkie porównania i przydziały pamięci,
+  a dopiero potem przenoszą elementy, więc K i V muszą mieć przenoszenie
+  niezgłaszające wyjątków. */
+template<typename K, typename V, typename Alloc = std::allocator<std::pair<K, V>>,
+         typename TieBreak = PriorityQueueKeyTieBreak>
+class FlatPriorityQueue {
+	static_assert(std::is_nothrow_move_constructible<K>::value && std::is_nothrow_move_assignable<K>::value
+	              && std::is_nothrow_move_constructible<V>::value && std::is_nothrow_move_assignable<V>::value,
+	              "FlatPriorityQueue requires K and V with no-throw move");
+
+	template<typename T>
+	using rebound = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+	using key_vector = std::vector<K, rebound<K>>;
+	using value_vector = std::vector<V, rebound<V>>;
+	using index_vector = std::vector<std::size_t, rebound<std::size_t>>;
+
+	/*keys[i] i values[i] to i-ta para w porządku (klucz, wartość), a order[r]
+	  to pozycja r-tej pary w porządku (wartość, klucz) */
+	key_vector keys;
+	value_vector values;
+	index_vector order;
+
+	static bool lessKV(const K &k1, const V &v1, const K &k2, const V &v2) {
+		return k1 < k2 || (!(k2 < k1) && v1 < v2);
+	}
+
+	static const bool stable = std::is_same<TieBreak, PriorityQueueFifoTieBreak>::value;
+
+	/*W trybie FIFO pary o równych wartościach zostają w kolejności wstawienia,
+	  więc porównywane są same wartości */
+	static bool lessVK(const V &v1, const K &k1, const V &v2, const K &k2) {
+		return v1 < v2 || (!stable && !(v2 < v1) && k1 < k2);
+	}
+
+	/*Pierwsza pozycja w [0, n), dla której before jest fałszywe, przy czym
+	  before jest prawdziwe na początku przedziału i fałszywe na końcu.
+	  Długość przedziału zmienia się niezależnie od wyników porównań, więc
+	  kompilator może zastąpić skoki przypisaniami warunkowymi. */
+	template<typename Before>
+	static std::size_t partition(std::size_t n, Before before) {
+		if (n == 0) {
+			return 0;
+		}
+		std::size_t base = 0;
+		while (n > 1) {
+			std::size_t half = n / 2;
+			base = before(base + half) ? base + half : base;
+			n -= half;
+		}
+		return base + (before(base) ? 1 : 0);
+	}
+
+	std::size_t lowerKey(const K &key) const {
+		return partition(keys.size(), [this, &key](std::size_t i) {
+			return keys[i] < key;
+		});
+	}
+
+	std::size_t upperKey(const K &key) const {
+		return partition(keys.size(), [this, &key](std::size_t i) {
+			return !(key < keys[i]);
+		});
+	}
+
+	/*Pozycja, na którą trafiłaby para (key, value) wstawiona za równymi jej parami */
+	std::size_t upperKV(const K &key, const V &value) const {
+		return partition(keys.size(), [this, &key, &value](std::size_t i) {
+			return !lessKV(key, value, keys[i], values[i]);
+		});
+	}
+
+	std::size_t upperVK(const V &value, const K &key) const {
+		return partition(order.size(), [this, &key, &value](std::size_t r) {
+			return !lessVK(value, key, values[order[r]], keys[order[r]]);
+		});
+	}
+
+	std::size_t lowerValue(const V &value) const {
+		return partition(order.size(), [this, &value](std::size_t r) {
+			return values[order[r]] < value;
+		});
+	}
+
+	/*Miejsce pozycji p w tablicy order */
+	std::size_t rankOf(std::size_t p) const {
+		std::size_t r = partition(order.size(), [this, p](std::size_t s) {
+			return lessVK(values[order[s]], keys[order[s]], values[p], keys[p]);
+		});
+		while (order[r] != p) {
+			r++;
+		}
+		return r;
+	}
+
+	template<typename T, typename A>
+	static void grow(std::vector<T, A> &v) {
+		if (v.size() == v.capacity()) {
+			v.reserve(v.size() ? 2 * v.size() : 1);
+		}
+	}
+
+	void removeAt(std::size_t p, std::size_t r) noexcept {
+		keys.erase(keys.begin() + p);
+		values.erase(values.begin() + p);
+		order.erase(order.begin() + r);
+		for (std::size_t &i : order) {
+			if (i > p) {
+				i--;
+			}
+		}
+	}
+
+	/*Przestawia parę z rangi from na rangę to w tablicy order */
+	void moveRank(std::size_t from, std::size_t to) noexcept {
+		if (from < to) {
+			std::rotate(order.begin() + from, order.begin() + from + 1, order.begin() + to + 1);
+		}
+		else {
+			std::rotate(order.begin() + to, order.begin() + from, order.begin() + from + 1);
+		}
+	}
+
+	/*Zastępuje zawartość parami z [first, last), sortowanymi naraz; sortowanie
+	  jest stabilne, więc pary równe w danym porządku zostają w kolejności zakresu */
+	template<typename InputIt>
+	void build(InputIt first, InputIt last) {
+		using element = std::pair<K, V>;
+		std::vector<element> pairs(first, last);
+		std::vector<std::size_t> byKey(pairs.size());
+		std::vector<std::size_t> byValue(pairs.size());
+		std::vector<std::size_t> position(pairs.size());
+		for (std::size_t i = 0; i < pairs.size(); i++) {
+			byKey[i] = byValue[i] = i;
+		}
+		std::stable_sort(byKey.begin(), byKey.end(), [&pairs](std::size_t a, std::size_t b) {
+			return lessKV(pairs[a].first, pairs[a].second, pairs[b].first, pairs[b].second);
+		});
+		std::stable_sort(byValue.begin(), byValue.end(), [&pairs](std::size_t a, std::size_t b) {
+			return lessVK(pairs[a].second, pairs[a].first, pairs[b].second, pairs[b].first);
+		});
+		key_vector k(keys.get_allocator());
+		value_vector v(values.get_allocator());
+		index_vector o(order.get_allocator());
+		k.reserve(pairs.size());
+		v.reserve(pairs.size());
+		o.reserve(pairs.size());
+		for (std::size_t i = 0; i < pairs.size(); i++) {
+			position[byKey[i]] = i;
+			k.push_back(std::move(pairs[byKey[i]].first));
+			v.push_back(std::move(pairs[byKey[i]].second));
+		}
+		for (std::size_t i : byValue) {
+			o.push_back(position[i]);
+		}
+		keys.swap(k);
+		values.swap(v);
+		order.swap(o);
+	}
+
+public:
+	using size_type = std::size_t;
+	using key_type = K;
+	using value_type = V;
+	using allocator_type = Alloc;
+
+	/*Dwukierunkowy iterator po parach w porządku kluczy (ByValue == false) albo
+	  wartości; *it zwraca parę referencji. Iteratory tracą ważność przy
+	  modyfikacji kolejki. */
+	template<bool ByValue>
+	class order_iterator {
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = std::pair<K, V>;
+		using difference_type = std::ptrdiff_t;
+		using reference = std::pair<const K &, const V &>;
+		using pointer = void;
+
+		order_iterator() noexcept
+			: owner(nullptr), rank(0) {
+		}
+
+		const K &key() const noexcept {
+			return owner->keys[index()];
+		}
+
+		const V &value() const noexcept {
+			return owner->values[index()];
+		}
+
+		reference operator*() const noexcept {
+			return reference(key(), value());
+		}
+
+		order_iterator &operator++() noexcept {
+			rank++;
+			return *this;
+		}
+
+		order_iterator operator++(int) noexcept {
+			order_iterator previous = *this;
+			++*this;
+			return previous;
+		}
+
+		order_iterator &operator--() noexcept {
+			rank--;
+			return *this;
+		}
+
+		order_iterator operator--(int) noexcept {
+			order_iterator previous = *this;
+			--*this;
+			return previous;
+		}
+
+		bool operator==(const order_iterator &other) const noexcept {
+			return rank == other.rank;
+		}
+
+		bool operator!=(const order_iterator &other) const noexcept {
+			return rank != other.rank;
+		}
+
+	private:
+		friend class FlatPriorityQueue;
+
+		order_iterator(const FlatPriorityQueue *queue, std::size_t position) noexcept
+			: owner(queue), rank(position) {
+		}
+
+		std::size_t index() const noexcept {
+			return ByValue ? owner->order[rank] : rank;
+		}
+
+		const FlatPriorityQueue *owner;
+		std::size_t rank;
+	};
+
+	/*Widok na fragment jednego z porządków; nadaje się do pętli for po zakresie */
+	template<bool ByValue>
+	class order_range {
+	public:
+		using iterator = order_iterator<ByValue>;
+
+		iterator begin() const noexcept {
+			return first;
+		}
+
+		iterator end() const noexcept {
+			return last;
+		}
+
+		bool empty() const noexcept {
+			return first == last;
+		}
+
+	private:
+		friend class FlatPriorityQueue;
+
+		order_range(iterator from, iterator to) noexcept
+			: first(from), last(to) {
+		}
+
+		iterator first;
+		iterator last;
+	};
+
+	using const_value_iterator = order_iterator<true>;
+	using const_key_iterator = order_iterator<false>;
+	using value_range = order_range<true>;
+	using key_range = order_range<false>;
+
+	/*Konstruktor bezparametrowy tworzący pustą kolejkę
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	FlatPriorityQueue() = default;
+
+	/*Konstruktor tworzący pustą kolejkę, która przydziela pamięć przez allocator
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	explicit FlatPriorityQueue(const Alloc &allocator)
+		: keys(rebound<K>(allocator)), values(rebound<V>(allocator)), order(rebound<std::size_t>(allocator)) {
+	}
+
+	/*Konstruktor tworzący kolejkę z par (klucz, wartość) z zakresu [first, last)
+	  Złożoność: O(n log n)
+	  Exception safety: strong */
+	template<typename InputIt>
+	FlatPriorityQueue(InputIt first, InputIt last, const Alloc &allocator = Alloc())
+		: FlatPriorityQueue(allocator) {
+		build(first, last);
+	}
+
+	/*Konstruktor kopiujący zawartość kolejki drzewiastej o tym samym TieBreak;
+	  pary są odczytywane w porządku kluczy, a porządek wartości jest brany
+	  z queue przez keyPositionsByValue, bez porównań i sortowania
+	  Złożoność: O(queue.size()) średnio
+	  Exception safety: strong */
+	template<typename A, typename Lookup, typename Stats>
+	explicit FlatPriorityQueue(const PriorityQueue<K, V, A, Lookup, Stats, TieBreak> &queue,
+	                           const Alloc &allocator = Alloc())
+		: FlatPriorityQueue(allocator) {
+		keys.reserve(queue.size());
+		values.reserve(queue.size());
+		order.reserve(queue.size());
+		for (auto it = queue.keyBegin(); it != queue.keyEnd(); ++it) {
+			keys.push_back(it.key());
+			values.push_back(it.value());
+		}
+		queue.keyPositionsByValue(std::back_inserter(order));
+	}
+
+	/*Konstruktor kopiujący
+	  Złożoność: O(queue.size())
+	  Exception safety: strong */
+	FlatPriorityQueue(const FlatPriorityQueue<K, V, Alloc, TieBreak> &queue) = default;
+
+	/*Konstruktor przenoszący
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	FlatPriorityQueue(FlatPriorityQueue<K, V, Alloc, TieBreak> &&queue) noexcept
+		: keys(std::move(queue.keys)), values(std::move(queue.values)), order(std::move(queue.order)) {
+	}
+
+	/*Operator przypisania dla użycia P = Q
+	  Złożoność: O(queue.size())
+	  Exception safety: strong */
+	FlatPriorityQueue<K, V, Alloc, TieBreak> &operator=(const FlatPriorityQueue<K, V, Alloc, TieBreak> &queue) {
+		if (&queue != this) {
+			FlatPriorityQueue<K, V, Alloc, TieBreak> copy(queue);
+			swap(copy);
+		}
+		return *this;
+	}
+
+	/*Operator przypisania dla użycia P = move(Q)
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	FlatPriorityQueue<K, V, Alloc, TieBreak> &operator=(FlatPriorityQueue<K, V, Alloc, TieBreak> &&queue) noexcept {
+		swap(queue);
+		return *this;
+	}
+
+	/*Metoda zwracająca alokator używany przez kolejkę
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	allocator_type get_allocator() const {
+		return allocator_type(keys.get_allocator());
+	}
+
+	/*Metoda zwracająca true wtedy i tylko wtedy, gdy kolejka jest pusta
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	bool empty() const {
+		return keys.empty();
+	}
+
+	/*Metoda zwracająca liczbę par (klucz, wartość) przechowywanych w kolejce
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	size_type size() const {
+		return keys.size();
+	}
+
+	/*Metoda wstawiająca do kolejki parę o kluczu key i wartości value
+	  Złożoność: O(size())
+	  Exception safety: strong */
+	void insert(const K &key, const V &value) {
+		K k(key);
+		V v(value);
+		std::size_t p = upperKV(k, v);
+		std::size_t r = upperVK(v, k);
+		grow(keys);
+		grow(values);
+		grow(order);
+		keys.insert(keys.begin() + p, std::move(k));
+		values.insert(values.begin() + p, std::move(v));
+		for (std::size_t &i : order) {
+			if (i >= p) {
+				i++;
+			}
+		}
+		order.insert(order.begin() + r, p);
+	}
+
+	/*Metoda wstawiająca pary z zakresu [first, last): są sortowane osobno
+	  i scalane z kolejką naraz
+	  Złożoność: O(n log n + size()) dla n wstawianych par
+	  Exception safety: strong */
+	template<typename InputIt>
+	void insert(InputIt first, InputIt last) {
+		FlatPriorityQueue<K, V, Alloc, TieBreak> added(first, last, get_allocator());
+		merge(added);
+	}
+
+	/*Metody zwracające iteratory po parach w porządku wartości albo kluczy
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	const_value_iterator valueBegin() const noexcept {
+		return const_value_iterator(this, 0);
+	}
+
+	const_value_iterator valueEnd() const noexcept {
+		return const_value_iterator(this, order.size());
+	}
+
+	const_key_iterator keyBegin() const noexcept {
+		return const_key_iterator(this, 0);
+	}
+
+	const_key_iterator keyEnd() const noexcept {
+		return const_key_iterator(this, keys.size());
+	}
+
+	/*Metody zwracające widok na pary o wartościach z przedziału [lo, hi)
+	  albo o kluczach z przedziału [lo, hi); dla hi <= lo widok jest pusty
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	value_range valueRange(const V &lo, const V &hi) const {
+		std::size_t from = lowerValue(lo);
+		std::size_t to = lo < hi ? lowerValue(hi) : from;
+		return value_range(const_value_iterator(this, from), const_value_iterator(this, to));
+	}
+
+	key_range keyRange(const K &lo, const K &hi) const {
+		std::size_t from = lowerKey(lo);
+		std::size_t to = lo < hi ? lowerKey(hi) : from;
+		return key_range(const_key_iterator(this, from), const_key_iterator(this, to));
+	}
+
+	/*Metody zwracające widok na wszystkie pary w porządku wartości albo kluczy
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	value_range byValue() const noexcept {
+		return value_range(valueBegin(), valueEnd());
+	}
+
+	key_range byKey() const noexcept {
+		return key_range(keyBegin(), keyEnd());
+	}
+
+	/*Metoda zwracająca najmniejszą wartość przechowywaną w kolejce
+	  Złożoność: O(1)
+	  Exception safety: strong */
+	const V &minValue() const {
+		if (empty()) {
+			throw PriorityQueueEmptyException();
+		}
+		return values[order.front()];
+	}
+
+	/*Metoda zwracająca największą wartość przechowywaną w kolejce
+	  Złożoność: O(1)
+	  Exception safety: strong */
+	const V &maxValue() const {
+		if (empty()) {
+			throw PriorityQueueEmptyException();
+		}
+		return values[order.back()];
+	}
+
+	/*Metoda zwracająca klucz o przypisanej najmniejszej wartości
+	  Złożoność: O(1)
+	  Exception safety: strong */
+	const K &minKey() const {
+		if (empty()) {
+			throw PriorityQueueEmptyException();
+		}
+		return keys[order.front()];
+	}
+
+	/*Metoda zwracająca klucz o przypisanej największej wartości
+	  Złożoność: O(1)
+	  Exception safety: strong */
+	const K &maxKey() const {
+		if (empty()) {
+			throw PriorityQueueEmptyException();
+		}
+		return keys[order.back()];
+	}
+
+	/*Metoda usuwająca z kolejki jedną parę o najmniejszej wartości
+	  Złożoność: O(size())
+	  Exception safety: no-throw */
+	void deleteMin() noexcept {
+		if (empty()) {
+			return;
+		}
+		removeAt(order.front(), 0);
+	}
+
+	/*Metoda usuwająca z kolejki jedną parę o największej wartości
+	  Złożoność: O(size())
+	  Exception safety: no-throw */
+	void deleteMax() noexcept {
+		if (empty()) {
+			return;
+		}
+		removeAt(order.back(), order.size() - 1);
+	}
+
+	/*Metoda zmieniająca dotychczasową wartość przypisaną kluczowi key na nową
+	  wartość value (dla wielu par o tym kluczu: wartość najmniejszą, jak
+	  w PriorityQueue); rzuca PriorityQueueNotFoundException, gdy klucza nie
+	  ma w kolejce
+	  Złożoność: O(size())
+	  Exception safety: strong */
+	void changeValue(const K &key, const V &value) {
+		std::size_t p = lowerKey(key);
+		if (p == size() || key < keys[p]) {
+			throw PriorityQueueNotFoundException();
+		}
+		V v(value);
+		// para zostaje w ciągu par o kluczu key, na miejscu za parami o wartości <= value
+		std::size_t q = upperKey(key);
+		q = p + 1 + partition(q - p - 1, [this, p, &v](std::size_t i) {
+			return !(v < values[p + 1 + i]);
+		});
+		std::size_t from = rankOf(p);
+		std::size_t to = upperVK(v, key);
+		to = from < to ? to - 1 : to;
+
+		values[p] = std::move(v);
+		std::rotate(keys.begin() + p, keys.begin() + p + 1, keys.begin() + q);
+		std::rotate(values.begin() + p, values.begin() + p + 1, values.begin() + q);
+		for (std::size_t &i : order) {
+			if (i == p) {
+				i = q - 1;
+			}
+			else if (p < i && i < q) {
+				i--;
+			}
+		}
+		moveRank(from, to);
+	}
+
+	/*Metoda zwracająca true wtedy i tylko wtedy, gdy w kolejce jest para o kluczu key
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	bool contains(const K &key) const {
+		std::size_t p = lowerKey(key);
+		return p != size() && !(key < keys[p]);
+	}
+
+	/*Metoda zwracająca liczbę par o kluczu key
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	size_type count(const K &key) const {
+		return upperKey(key) - lowerKey(key);
+	}
+
+	/*Metoda scalająca zawartość kolejki z podaną kolejką queue; ta operacja usuwa
+	  wszystkie elementy z kolejki queue i wstawia je do kolejki *this. Oba
+	  porządki są scalane jak w sortowaniu przez scalanie: najpierw powstaje
+	  plan scalenia, a pary są przenoszone dopiero po wszystkich porównaniach.
+	  Złożoność: O(size() + queue.size())
+	  Exception safety: strong */
+	void merge(FlatPriorityQueue<K, V, Alloc, TieBreak> &queue) {
+		if (&queue == this || queue.empty()) {
+			return;
+		}
+		std::size_t n = size();
+		std::size_t m = queue.size();
+		index_vector mine(n, 0, order.get_allocator());
+		index_vector theirs(m, 0, order.get_allocator());
+		std::size_t i = 0;
+		std::size_t j = 0;
+		while (i < n || j < m) {
+			if (j == m || (i < n && !lessKV(queue.keys[j], queue.values[j], keys[i], values[i]))) {
+				mine[i] = i + j;
+				i++;
+			}
+			else {
+				theirs[j] = i + j;
+				j++;
+			}
+		}
+		index_vector merged(order.get_allocator());
+		merged.reserve(n + m);
+		i = 0;
+		j = 0;
+		while (i < n || j < m) {
+			if (j == m || (i < n && !lessVK(queue.values[queue.order[j]], queue.keys[queue.order[j]],
+			                                values[order[i]], keys[order[i]]))) {
+				merged.push_back(mine[order[i++]]);
+			}
+			else {
+				merged.push_back(theirs[queue.order[j++]]);
+			}
+		}
+		key_vector k(keys.get_allocator());
+		value_vector v(values.get_allocator());
+		k.reserve(n + m);
+		v.reserve(n + m);
+
+		i = 0;
+		j = 0;
+		while (i < n || j < m) {
+			if (j == m || (i < n && mine[i] == i + j)) {
+				k.push_back(std::move(keys[i]));
+				v.push_back(std::move(values[i++]));
+			}
+			else {
+				k.push_back(std::move(queue.keys[j]));
+				v.push_back(std::move(queue.values[j++]));
+			}
+		}
+		keys.swap(k);
+		values.swap(v);
+		order.swap(merged);
+		queue.keys.clear();
+		queue.values.clear();
+		queue.order.clear();
+	}
+
+	/*Metoda zamieniającą zawartość kolejki z podaną kolejką queue
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	void swap(FlatPriorityQueue<K, V, Alloc, TieBreak> &queue) noexcept {
+		keys.swap(queue.keys);
+		values.swap(queue.values);
+		order.swap(queue.order);
+	}
+
+	/*Operator porównania
+	  Złożoność: O(size())
+	  Exception safety: strong */
+	bool operator==(const FlatPriorityQueue &queue) const {
+		if (size() != queue.size()) {
+			return false;
+		}
+		for (std::size_t i = 0; i < size(); i++) {
+			if (!(keys[i] == queue.keys[i]) || !(values[i] == queue.values[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/*Operator porównania leksykograficznego ciągów par w porządku kluczy,
+	  jak w PriorityQueue
+	  Złożoność: O(size())
+	  Exception safety: strong */
+	bool operator<(const FlatPriorityQueue &queue) const {
+		std::size_t n = std::min(size(), queue.size());
+		for (std::size_t i = 0; i < n; i++) {
+			if (lessKV(keys[i], values[i], queue.keys[i], queue.values[i])) {
+				return true;
+			}
+			if (lessKV(queue.keys[i], queue.values[i], keys[i], values[i])) {
+				return false;
+			}
+		}
+		return size() < queue.size();
+	}
+};
+
+/*Funkcja zamieniająca kolejkę drzewiastą na kolejkę FlatPriorityQueue o tej
+  samej zawartości, np. gdy kolejka jest już zbudowana i dalej będzie tylko
+  odczytywana; queue zostaje bez zmian. Wynik przydziela pamięć kopią
+  alokatora queue, przestawioną na pary (K, V), i ma ten sam TieBreak.
+  Złożoność: jak konstruktor FlatPriorityQueue(queue)
+  Exception safety: strong */
+template<typename K, typename V, typename A, typename Lookup, typename Stats, typename TieBreak>
+FlatPriorityQueue<K, V, typename std::allocator_traits<A>::template rebind_alloc<std::pair<K, V>>, TieBreak>
+freeze(const PriorityQueue<K, V, A, Lookup, Stats, TieBreak> &queue) {
+	using allocator = typename std::allocator_traits<A>::template rebind_alloc<std::pair<K, V>>;
+	return FlatPriorityQueue<K, V, allocator, TieBreak>(queue, allocator(queue.get_allocator()));
+}
+
+/*Funkcja jak freeze(queue), której wynik przydziela pamięć przez allocator
+  Złożoność: jak konstruktor FlatPriorityQueue(queue)
+  Exception safety: strong */
+template<typename K, typename V, typename A, typename Lookup, typename Stats, typename TieBreak, typename Alloc>
+FlatPriorityQueue<K, V, Alloc, TieBreak> freeze(const PriorityQueue<K, V, A, Lookup, Stats, TieBreak> &queue,
+                                                   const Alloc &allocator) {
+	return FlatPriorityQueue<K, V, Alloc, TieBreak>(queue, allocator);
+}
+
+/*Operator porównania
+  Złożoność: O(size())
+  Exception safety: strong */
+template<typename K, typename V, typename Alloc, typename TieBreak>
+bool operator!=(const FlatPriorityQueue<K, V, Alloc, TieBreak> &first, const FlatPriorityQueue<K, V, Alloc, TieBreak> &second) {
+	return !(first == second);
+}
+
+/*Operator porównania
+  Złożoność: O(size())
+  Exception safety: strong */
+template<typename K, typename V, typename Alloc, typename TieBreak>
+bool operator>(const FlatPriorityQueue<K, V, Alloc, TieBreak> &first, const FlatPriorityQueue<K, V, Alloc, TieBreak> &second) {
+	return second < first;
+}
+
+/*Operator porównania
+  Złożoność: O(size())
+  Exception safety: strong */
+template<typename K, typename V, typename Alloc, typename TieBreak>
+bool operator>=(const FlatPriorityQueue<K, V, Alloc, TieBreak> &first, const FlatPriorityQueue<K, V, Alloc, TieBreak> &second) {
+	return !(first < second);
+}
+
+/*Operator porównania
+  Złożoność: O(size())
+  Exception safety: strong */
+template<typename K, typename V, typename Alloc, typename TieBreak>
+bool operator<=(const FlatPriorityQueue<K, V, Alloc, TieBreak> &first, const FlatPriorityQueue<K, V, Alloc, TieBreak> &second) {
+	return !(second < first);
+}
+
+/*Funkcja zamieniającą zawartość dwóch kolejek
+  Złożoność: O(1)
+  Exception safety: no-throw */
+template<typename K, typename V, typename Alloc, typename TieBreak>
+void swap(FlatPriorityQueue<K, V, Alloc, TieBreak> &first, FlatPriorityQueue<K, V, Alloc, TieBreak> &second) noexcept {
+	first.swap(second);
+}
+
+#endif //FLATQUEUE_HH
@@ -0,0 +1,491 @@
+#ifndef HEAPQUEUE_HH
+#define HEAPQUEUE_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+/*Kolejka o tym samym interfejsie co PriorityQueue<K, V>, oparta na kopcu
+  min-max trzymanym w jednym ciągłym wektorze. Przeznaczona dla użyć, które
+  sprowadzają się do insert/minValue/minKey/deleteMin (oraz wersji max).
+  Operacje wymagające wyszukania klucza (changeValue) i porównania kolejek
+  są liniowe lub liniowo-logarytmiczne.
+
+  Każda modyfikacja kopca wykonuje się wyłącznie przez zamiany elementów,
+  które są zapisywane w dzienniku; gdy porównanie zgłosi wyjątek, zamiany są
+  cofane w odwrotnej kolejności. Dlatego K i V muszą mieć przenoszenie
+  niezgłaszające wyjątków. */
+template<typename K, typename V, typename Alloc = std::allocator<std::pair<K, V>>>
+class HeapPriorityQueue {
+	static_assert(std::is_nothrow_move_constructible<K>::value && std::is_nothrow_move_assignable<K>::value
+	              && std::is_nothrow_move_constructible<V>::value && std::is_nothrow_move_assignable<V>::value,
+	              "HeapPriorityQueue requires K and V with no-throw move");
+
+private:
+	using element = std::pair<K, V>;
+	using element_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<element>;
+	using element_vector = std::vector<element, element_allocator>;
+
+	/*Dziennik zamian; kopiec o rozmiarze mieszczącym się w size_t ma mniej
+	  niż 64 poziomy, więc jedna operacja wykonuje ograniczoną liczbę zamian */
+	class journal {
+	public:
+		explicit journal(element_vector &elements) noexcept
+			: heap(elements), count(0) {
+		}
+
+		void swap(std::size_t i, std::size_t j) noexcept {
+			using std::swap;
+			swap(heap[i], heap[j]);
+			first[count] = i;
+			second[count] = j;
+			count++;
+		}
+
+		void reset() noexcept {
+			count = 0;
+		}
+
+		void rollback() noexcept {
+			using std::swap;
+			while (count) {
+				count--;
+				swap(heap[first[count]], heap[second[count]]);
+			}
+		}
+
+	private:
+		static const std::size_t capacity = 4 * 64 + 8;
+		element_vector &heap;
+		std::size_t first[capacity];
+		std::size_t second[capacity];
+		std::size_t count;
+	};
+
+	element_vector heap;
+
+	static bool less(const element &a, const element &b) {
+		if (a.second < b.second) {
+			return true;
+		}
+		if (b.second < a.second) {
+			return false;
+		}
+		return a.first < b.first;
+	}
+
+	static bool lessKV(const element &a, const element &b) {
+		if (a.first < b.first) {
+			return true;
+		}
+		if (b.first < a.first) {
+			return false;
+		}
+		return a.second < b.second;
+	}
+
+	static bool onMinLevel(std::size_t i) noexcept {
+		std::size_t level = 0;
+		for (i++; i > 1; i >>= 1) {
+			level++;
+		}
+		return level % 2 == 0;
+	}
+
+	static std::size_t parent(std::size_t i) noexcept {
+		return (i - 1) / 2;
+	}
+
+	/*Czy a powinno leżeć bliżej korzenia niż b na poziomie danego rodzaju */
+	static bool before(const element &a, const element &b, bool minLevel) {
+		return minLevel ? less(a, b) : less(b, a);
+	}
+
+	/*Przesuwa element po dziadkach tak długo, jak jest to potrzebne;
+	  zwraca true, gdy element się przesunął */
+	bool bubbleUp(journal &log, std::size_t i, bool minLevel) {
+		bool moved = false;
+		while (i > 2) {
+			std::size_t grandparent = parent(parent(i));
+			if (!before(heap[i], heap[grandparent], minLevel)) {
+				break;
+			}
+			log.swap(i, grandparent);
+			i = grandparent;
+			moved = true;
+		}
+		return moved;
+	}
+
+	void trickleDown(journal &log, std::size_t i, std::size_t size) {
+		bool minLevel = onMinLevel(i);
+		while (2 * i + 1 < size) {
+			std::size_t best = 2 * i + 1;
+			std::size_t candidates[] = {2 * i + 2, 4 * i + 3, 4 * i + 4, 4 * i + 5, 4 * i + 6};
+			for (std::size_t c : candidates) {
+				if (c < size && before(heap[c], heap[best], minLevel)) {
+					best = c;
+				}
+			}
+			if (!before(heap[best], heap[i], minLevel)) {
+				return;
+			}
+			log.swap(best, i);
+			if (best <= 2 * i + 2) {
+				return;
+			}
+			if (before(heap[parent(best)], heap[best], minLevel)) {
+				log.swap(best, parent(best));
+			}
+			i = best;
+		}
+	}
+
+	/*Przywraca własność kopca po dowolnej zmianie elementu na pozycji i */
+	void fix(journal &log, std::size_t i, std::size_t size) {
+		if (i == 0) {
+			trickleDown(log, i, size);
+			return;
+		}
+		bool minLevel = onMinLevel(i);
+		std::size_t p = parent(i);
+		if (before(heap[p], heap[i], minLevel)) {
+			log.swap(i, p);
+			bubbleUp(log, p, !minLevel);
+			trickleDown(log, i, size);
+		}
+		else if (!bubbleUp(log, i, minLevel)) {
+			trickleDown(log, i, size);
+		}
+	}
+
+	std::size_t maxIndex() const {
+		std::size_t i = heap.size() > 1 ? 1 : 0;
+		if (i + 1 < heap.size() && less(heap[i], heap[i + 1])) {
+			i++;
+		}
+		return i;
+	}
+
+	/*Usuwa element z pozycji i
+	  Exception safety: strong */
+	void removeAt(std::size_t i) {
+		std::size_t last = heap.size() - 1;
+		journal log(heap);
+		log.swap(i, last);
+		if (i < last) {
+			try {
+				fix(log, i, last);
+			}
+			catch (...) {
+				log.rollback();
+				throw;
+			}
+		}
+		heap.pop_back();
+	}
+
+	/*Buduje kopiec z dowolnie ułożonych elementów
+	  Złożoność: O(heap.size()) */
+	void heapify() {
+		journal log(heap);
+		for (std::size_t i = heap.size() / 2; i-- > 0;) {
+			trickleDown(log, i, heap.size());
+			log.reset();
+		}
+	}
+
+	/*Tymczasowy bufor, więc korzysta z std::allocator, a nie z Alloc */
+	using pointer_vector = std::vector<const element *>;
+
+	pointer_vector sortedByKey() const {
+		pointer_vector sorted;
+		sorted.reserve(heap.size());
+		for (const element &e : heap) {
+			sorted.push_back(&e);
+		}
+		std::sort(sorted.begin(), sorted.end(), [](const element *a, const element *b) {
+			return lessKV(*a, *b);
+		});
+		return sorted;
+	}
+
+public:
+	using size_type = std::size_t;
+	using key_type = K;
+	using value_type = V;
+	using allocator_type = Alloc;
+
+	/*Konstruktor bezparametrowy tworzący pustą kolejkę
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	HeapPriorityQueue() = default;
+
+	/*Konstruktor tworzący pustą kolejkę, która przydziela pamięć przez allocator
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	explicit HeapPriorityQueue(const Alloc &allocator)
+		: heap(element_allocator(allocator)) {
+	}
+
+	/*Konstruktor kopiujący
+	  Złożoność: O(queue.size())
+	  Exception safety: strong */
+	HeapPriorityQueue(const HeapPriorityQueue<K, V, Alloc> &queue) = default;
+
+	/*Konstruktor przenoszący
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	HeapPriorityQueue(HeapPriorityQueue<K, V, Alloc> &&queue) noexcept
+		: heap(std::move(queue.heap)) {
+	}
+
+	/*Operator przypisania dla użycia P = Q
+	  Złożoność: O(queue.size())
+	  Exception safety: strong */
+	HeapPriorityQueue<K, V, Alloc> &operator=(const HeapPriorityQueue<K, V, Alloc> &queue) {
+		if (&queue == this) {
+			return *this;
+		}
+		element_vector copy(queue.heap);
+		heap.swap(copy);
+		return *this;
+	}
+
+	/*Operator przypisania dla użycia P = move(Q)
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	HeapPriorityQueue<K, V, Alloc> &operator=(HeapPriorityQueue<K, V, Alloc> &&queue) noexcept {
+		heap = std::move(queue.heap);
+		return *this;
+	}
+
+	/*Metoda zwracająca alokator używany przez kolejkę
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	allocator_type get_allocator() const {
+		return allocator_type(heap.get_allocator());
+	}
+
+	/*Metoda zwracająca true wtedy i tylko wtedy, gdy kolejka jest pusta
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	bool empty() const {
+		return heap.empty();
+	}
+
+	/*Metoda zwracająca liczbę par (klucz, wartość) przechowywanych w kolejce
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	size_type size() const {
+		return heap.size();
+	}
+
+	/*Metoda wstawiająca do kolejki parę o kluczu key i wartości value
+	  Złożoność: O(log size()) (zamortyzowana)
+	  Exception safety: strong */
+	void insert(const K &key, const V &value) {
+		heap.emplace_back(key, value);
+		journal log(heap);
+		try {
+			fix(log, heap.size() - 1, heap.size());
+		}
+		catch (...) {
+			log.rollback();
+			heap.pop_back();
+			throw;
+		}
+	}
+
+	/*Metoda zwracająca najmniejszą wartość przechowywaną w kolejce
+	  Złożoność: O(1)
+	  Exception safety: strong */
+	const V &minValue() const {
+		if (empty()) {
+			throw PriorityQueueEmptyException();
+		}
+		return heap.front().second;
+	}
+
+	/*Metoda zwracająca największą wartość przechowywaną w kolejce
+	  Złożoność: O(1)
+	  Exception safety: strong */
+	const V &maxValue() const {
+		if (empty()) {
+			throw PriorityQueueEmptyException();
+		}
+		return heap[maxIndex()].second;
+	}
+
+	/*Metoda zwracająca klucz o przypisanej najmniejszej wartości
+	  Złożoność: O(1)
+	  Exception safety: strong */
+	const K &minKey() const {
+		if (empty()) {
+			throw PriorityQueueEmptyException();
+		}
+		return heap.front().first;
+	}
+
+	/*Metoda zwracająca klucz o przypisanej największej wartości
+	  Złożoność: O(1)
+	  Exception safety: strong */
+	const K &maxKey() const {
+		if (empty()) {
+			throw PriorityQueueEmptyException();
+		}
+		return heap[maxIndex()].first;
+	}
+
+	/*Metoda usuwająca z kolejki jedną parę o najmniejszej wartości
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	void deleteMin() {
+		if (empty()) {
+			return;
+		}
+		removeAt(0);
+	}
+
+	/*Metoda usuwająca z kolejki jedną parę o największej wartości
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	void deleteMax() {
+		if (empty()) {
+			return;
+		}
+		removeAt(maxIndex());
+	}
+
+	/*Metoda zmieniająca dotychczasową wartość przypisaną kluczowi key na nową wartość value
+	  Złożoność: O(size()) (wyszukanie klucza) + O(log size())
+	  Exception safety: strong */
+	void changeValue(const K &key, const V &value) {
+		std::size_t i = 0;
+		while (i < heap.size() && (heap[i].first < key || key < heap[i].first)) {
+			i++;
+		}
+		if (i == heap.size()) {
+			throw PriorityQueueNotFoundException();
+		}
+		V replacement(value);
+		using std::swap;
+		swap(heap[i].second, replacement);
+		journal log(heap);
+		try {
+			fix(log, i, heap.size());
+		}
+		catch (...) {
+			log.rollback();
+			swap(heap[i].second, replacement);
+			throw;
+		}
+	}
+
+	/*Metoda scalająca zawartość kolejki z podaną kolejką queue; ta operacja usuwa
+	  wszystkie elementy z kolejki queue i wstawia je do kolejki *this
+	  Złożoność: O(size() + queue.size())
+	  Exception safety: strong */
+	void merge(HeapPriorityQueue<K, V, Alloc> &queue) {
+		if (&queue == this) {
+			return;
+		}
+		element_vector merged(heap.get_allocator());
+		merged.reserve(heap.size() + queue.heap.size());
+		merged.insert(merged.end(), heap.begin(), heap.end());
+		merged.insert(merged.end(), queue.heap.begin(), queue.heap.end());
+		merged.swap(heap);
+		try {
+			heapify();
+		}
+		catch (...) {
+			merged.swap(heap);
+			throw;
+		}
+		queue.heap.clear();
+	}
+
+	/*Metoda zamieniającą zawartość kolejki z podaną kolejką queue (tak jak
+      większość kontenerów w bibliotece standardowej)
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	void swap(HeapPriorityQueue<K, V, Alloc> &queue) noexcept {
+		heap.swap(queue.heap);
+	}
+
+	/*Operator porównania
+	  Złożoność: O(size() * log size())
+	  Exception safety: strong */
+	bool operator==(const HeapPriorityQueue &queue) const {
+		if (size() != queue.size()) {
+			return false;
+		}
+		pointer_vector mine = sortedByKey();
+		pointer_vector theirs = queue.sortedByKey();
+		for (std::size_t i = 0; i < mine.size(); i++) {
+			if (!(mine[i]->first == theirs[i]->first) || !(mine[i]->second == theirs[i]->second)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/*Operator porównania
+	  Złożoność: O(size() * log size())
+	  Exception safety: strong */
+	bool operator<(const HeapPriorityQueue &queue) const {
+		pointer_vector mine = sortedByKey();
+		pointer_vector theirs = queue.sortedByKey();
+		return std::lexicographical_compare(mine.begin(), mine.end(), theirs.begin(), theirs.end(),
+			[](const element *a, const element *b) {
+				return lessKV(*a, *b);
+			});
+	}
+};
+
+/*Operator porównania
+  Złożoność: O(size() * log size())
+  Exception safety: strong */
+template<typename K, typename V, typename Alloc>
+bool operator!=(const HeapPriorityQueue<K, V, Alloc> &first, const HeapPriorityQueue<K, V, Alloc> &second) {
+	return !(first == second);
+}
+
+/*Operator porównania
+  Złożoność: O(size() * log size())
+  Exception safety: strong */
+template<typename K, typename V, typename Alloc>
+bool operator>(const HeapPriorityQueue<K, V, Alloc> &first, const HeapPriorityQueue<K, V, Alloc> &second) {
+	return second < first;
+}
+
+/*Operator porównania
+  Złożoność: O(size() * log size())
+  Exception safety: strong */
+template<typename K, typename V, typename Alloc>
+bool operator>=(const HeapPriorityQueue<K, V, Alloc> &first, const HeapPriorityQueue<K, V, Alloc> &second) {
+	return !(first < second);
+}
+
+/*Operator porównania
+  Złożoność: O(size() * log size())
+  Exception safety: strong */
+template<typename K, typename V, typename Alloc>
+bool operator<=(const HeapPriorityQueue<K, V, Alloc> &first, const HeapPriorityQueue<K, V, Alloc> &second) {
+	return !(second < first);
+}
+
+/*Funkcja zamieniającą zawartość dwóch kolejek
+  Złożoność: O(1)
+  Exception safety: no-throw */
+template<typename K, typename V, typename Alloc>
+void swap(HeapPriorityQueue<K, V, Alloc> &first, HeapPriorityQueue<K, V, Alloc> &second) {
+	first.swap(second);
+}
+
+#endif //HEAPQUEUE_HH
@@ -0,0 +1,166 @@
+#ifndef INTERN_HH
+#define INTERN_HH
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+template<typename T, typename Hash>
+class PriorityQueueInternPool;
+
+/*Uchwyt do wartości typu T przechowywanej w PriorityQueueInternPool. Równe
+  wartości z jednej puli mają jedną wspólną kopię z licznikiem odwołań, więc
+  np. PriorityQueue<int, Interned<std::string>> trzyma w węźle tylko wskaźnik.
+  Kopiowanie i niszczenie uchwytów nie blokuje puli. Pula musi żyć dłużej niż
+  wszystkie jej uchwyty. */
+template<typename T, typename Hash = std::hash<T>>
+class Interned {
+public:
+	Interned(const Interned &other) noexcept : entry(other.entry) {
+		acquire();
+	}
+
+	Interned(Interned &&other) noexcept : entry(other.entry) {
+		other.entry = nullptr;
+	}
+
+	Interned &operator=(Interned other) noexcept {
+		std::swap(entry, other.entry);
+		return *this;
+	}
+
+	~Interned() {
+		if (entry) {
+			entry->second.fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	/*Metoda zwracająca przechowywaną wartość; nie wolno jej wywoływać dla
+	  uchwytu, z którego wartość została przeniesiona */
+	const T &get() const noexcept {
+		return entry->first;
+	}
+
+	operator const T &() const noexcept {
+		return entry->first;
+	}
+
+	/*Uchwyty z tej samej puli są równe wtedy i tylko wtedy, gdy wskazują na
+	  ten sam wpis, więc porównanie zaczyna się od porównania wskaźników */
+	bool operator==(const Interned &other) const {
+		return entry == other.entry || entry->first == other.entry->first;
+	}
+
+	bool operator!=(const Interned &other) const {
+		return !(*this == other);
+	}
+
+	bool operator<(const Interned &other) const {
+		return entry != other.entry && entry->first < other.entry->first;
+	}
+
+private:
+	using entry_type = std::pair<const T, std::atomic<std::size_t>>;
+
+	friend class PriorityQueueInternPool<T, Hash>;
+
+	entry_type *entry;
+
+	explicit Interned(entry_type *target) noexcept : entry(target) {
+		acquire();
+	}
+
+	void acquire() noexcept {
+		if (entry) {
+			entry->second.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+};
+
+template<typename T, typename Hash>
+bool operator>(const Interned<T, Hash> &first, const Interned<T, Hash> &second) {
+	return second < first;
+}
+
+template<typename T, typename Hash>
+bool operator<=(const Interned<T, Hash> &first, const Interned<T, Hash> &second) {
+	return !(second < first);
+}
+
+template<typename T, typename Hash>
+bool operator>=(const Interned<T, Hash> &first, const Interned<T, Hash> &second) {
+	return !(first < second);
+}
+
+namespace std {
+	template<typename T, typename Hash>
+	struct hash<Interned<T, Hash>> {
+		std::size_t operator()(const Interned<T, Hash> &value) const {
+			return Hash()(value.get());
+		}
+	};
+}
+
+/*Pula wartości współdzielona przez dowolnie wiele par i kolejek. Wpisy, do
+  których nie ma już uchwytów, są usuwane dopiero przez purge() albo
+  w destruktorze, więc zwalnianie uchwytów nie wymaga blokady. intern i purge
+  są bezpieczne wielowątkowo. */
+template<typename T, typename Hash = std::hash<T>>
+class PriorityQueueInternPool {
+public:
+	using handle_type = Interned<T, Hash>;
+
+	PriorityQueueInternPool() = default;
+	PriorityQueueInternPool(const PriorityQueueInternPool &) = delete;
+	PriorityQueueInternPool &operator=(const PriorityQueueInternPool &) = delete;
+
+	/*Metoda zwracająca uchwyt do wartości równej value, tworząc jej kopię
+	  w puli, gdy jeszcze jej tam nie ma
+	  Złożoność: O(1) średnio
+	  Exception safety: strong */
+	handle_type intern(const T &value) {
+		std::lock_guard<std::mutex> guard(lock);
+		auto it = entries.find(value);
+		if (it == entries.end()) {
+			it = entries.emplace(std::piecewise_construct, std::forward_as_tuple(value),
+			                     std::forward_as_tuple(0)).first;
+		}
+		return handle_type(&*it);
+	}
+
+	/*Metoda usuwająca z puli wartości, do których nie ma już uchwytów;
+	  zwraca liczbę usuniętych wartości
+	  Złożoność: O(size())
+	  Exception safety: no-throw */
+	std::size_t purge() noexcept {
+		std::lock_guard<std::mutex> guard(lock);
+		std::size_t removed = 0;
+		for (auto it = entries.begin(); it != entries.end();) {
+			if (it->second.load(std::memory_order_acquire) == 0) {
+				it = entries.erase(it);
+				removed++;
+			}
+			else {
+				++it;
+			}
+		}
+		return removed;
+	}
+
+	/*Metoda zwracająca liczbę różnych wartości w puli (także tych czekających na purge)
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	std::size_t size() const noexcept {
+		std::lock_guard<std::mutex> guard(lock);
+		return entries.size();
+	}
+
+private:
+	mutable std::mutex lock;
+	std::unordered_map<T, std::atomic<std::size_t>, Hash> entries;
+};
+
+#endif //INTERN_HH
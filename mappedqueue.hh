@@ -0,0 +1,167 @@
+#ifndef MAPPEDQUEUE_HH
+#define MAPPEDQUEUE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "priorityqueue.hh"
+
+/*Kolejka tylko do odczytu, odpowiadająca na zapytania wprost z pliku
+  zapisanego przez PriorityQueue::save, odwzorowanego w pamięć (POSIX mmap).
+  Otwarcie sprawdza tylko nagłówek i rozmiar pliku, więc kosztuje O(1)
+  niezależnie od liczby par. K i V muszą być trywialnie kopiowalne. */
+template<typename K, typename V>
+class MappedPriorityQueue {
+	static_assert(std::is_trivially_copyable<K>::value && std::is_trivially_copyable<V>::value,
+	              "MappedPriorityQueue requires trivially copyable K and V");
+
+public:
+	using size_type = std::size_t;
+	using key_type = K;
+	using value_type = V;
+
+	/*Konstruktor odwzorowujący plik path; rzuca PriorityQueueFileException,
+	  gdy pliku nie da się otworzyć albo nie pasuje do typów K i V
+	  Złożoność: O(1)
+	  Exception safety: strong */
+	explicit MappedPriorityQueue(const std::string &path)
+		: base(nullptr), length(0), records(nullptr), order(nullptr), elements(0) {
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			throw PriorityQueueFileException();
+		}
+		struct stat info;
+		if (::fstat(fd, &info) != 0 || static_cast<std::uint64_t>(info.st_size) < sizeof(PriorityQueueFileHeader)) {
+			::close(fd);
+			throw PriorityQueueFileException();
+		}
+		length = static_cast<std::size_t>(info.st_size);
+		void *mapped = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (mapped == MAP_FAILED) {
+			throw PriorityQueueFileException();
+		}
+		base = static_cast<const char *>(mapped);
+		const PriorityQueueFileHeader *header = reinterpret_cast<const PriorityQueueFileHeader *>(base);
+		if (!header->template matches<K, V, record>(length)) {
+			::munmap(mapped, length);
+			throw PriorityQueueFileException();
+		}
+		records = reinterpret_cast<const record *>(base + header->recordsOffset);
+		order = reinterpret_cast<const std::uint64_t *>(base + header->orderOffset);
+		elements = static_cast<std::size_t>(header->count);
+	}
+
+	MappedPriorityQueue(const MappedPriorityQueue &) = delete;
+	MappedPriorityQueue &operator=(const MappedPriorityQueue &) = delete;
+
+	/*Konstruktor przenoszący
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	MappedPriorityQueue(MappedPriorityQueue &&queue) noexcept
+		: base(queue.base), length(queue.length), records(queue.records),
+		  order(queue.order), elements(queue.elements) {
+		queue.base = nullptr;
+		queue.elements = 0;
+	}
+
+	/*Desktruktor; zwalnia odwzorowanie
+	  Exception safety: no-throw */
+	~MappedPriorityQueue() {
+		if (base) {
+			::munmap(const_cast<char *>(base), length);
+		}
+	}
+
+	bool empty() const noexcept {
+		return elements == 0;
+	}
+
+	size_type size() const noexcept {
+		return elements;
+	}
+
+	/*Metody zwracające skrajne wartości i ich klucze; rzucają
+	  PriorityQueueEmptyException dla pustej kolejki
+	  Złożoność: O(1)
+	  Exception safety: strong */
+	const V &minValue() const {
+		return byValue(0).second;
+	}
+
+	const V &maxValue() const {
+		return byValue(elements - 1).second;
+	}
+
+	const K &minKey() const {
+		return byValue(0).first;
+	}
+
+	const K &maxKey() const {
+		return byValue(elements - 1).first;
+	}
+
+	/*Metoda zwracająca liczbę par o kluczu key
+	  Złożoność: O(log size() + wynik)
+	  Exception safety: strong */
+	size_type count(const K &key) const {
+		size_type result = 0;
+		for (size_type i = lowerBound(key); i < elements && !(key < records[i].first); i++) {
+			result++;
+		}
+		return result;
+	}
+
+	/*Metoda zwracająca true wtedy i tylko wtedy, gdy w kolejce jest para o kluczu key
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	bool contains(const K &key) const {
+		size_type i = lowerBound(key);
+		return i < elements && !(key < records[i].first);
+	}
+
+private:
+	using record = PriorityQueueFileRecord<K, V>;
+
+	const char *base;
+	std::size_t length;
+	const record *records;
+	const std::uint64_t *order;
+	std::size_t elements;
+
+	const record &byValue(std::size_t rank) const {
+		if (empty()) {
+			throw PriorityQueueEmptyException();
+		}
+		std::uint64_t index = order[rank];
+		if (index >= elements) {
+			throw PriorityQueueFileException();
+		}
+		return records[index];
+	}
+
+	size_type lowerBound(const K &key) const {
+		size_type first = 0;
+		size_type remaining = elements;
+		while (remaining > 0) {
+			size_type half = remaining / 2;
+			if (records[first + half].first < key) {
+				first += half + 1;
+				remaining -= half + 1;
+			}
+			else {
+				remaining = half;
+			}
+		}
+		return first;
+	}
+};
+
+#endif //MAPPEDQUEUE_HH
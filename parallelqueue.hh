@@ -0,0 +1,106 @@
+#ifndef PARALLELQUEUE_HH
+#define PARALLELQUEUE_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+/*Polityka wykonania operacji zbiorczych PriorityQueue na wielu wątkach, np.
+  PriorityQueue<K, V> P(PriorityQueueParallel(), pairs.begin(), pairs.end()).
+  Porządek kluczy i porządek wartości są przetwarzane przez osobne wątki,
+  a każdy z nich jest sortowany przez sortowanie przez scalanie: fragmenty
+  sortowane współbieżnie i scalane parami, też współbieżnie. Gdy wątku nie
+  da się utworzyć, zadanie jest wykonywane w bieżącym wątku, więc polityka
+  sama nie zgłasza wyjątków poza wyjątkami z zadań. Wymaga kompilacji
+  z obsługą wątków (-pthread). */
+class PriorityQueueParallel : public PriorityQueueExecutionPolicy {
+public:
+	/*threads to największa liczba wątków sortujących jeden porządek
+	  (0 oznacza std::thread::hardware_concurrency()), a chunk to najmniejsza
+	  liczba elementów sortowana przez jeden wątek */
+	explicit PriorityQueueParallel(std::size_t threads = 0, std::size_t chunk = 1 << 14) noexcept
+		: workers(threads ? threads : std::max<std::size_t>(1, std::thread::hardware_concurrency())),
+		  grain(chunk ? chunk : 1) {
+	}
+
+	/*Wykonuje f w osobnym wątku, a g w bieżącym, i czeka na oba; wyjątek
+	  zgłoszony przez f albo g jest zgłaszany dalej po zakończeniu obu */
+	template<typename F, typename G>
+	void invoke(F &&f, G &&g) const {
+		std::exception_ptr failure;
+		std::thread helper;
+		try {
+			helper = std::thread([&f, &failure]() {
+				try {
+					f();
+				}
+				catch (...) {
+					failure = std::current_exception();
+				}
+			});
+		}
+		catch (const std::system_error &) {
+			run(f, failure);
+		}
+		std::exception_ptr own;
+		run(g, own);
+		if (helper.joinable()) {
+			helper.join();
+		}
+		if (failure) {
+			std::rethrow_exception(failure);
+		}
+		if (own) {
+			std::rethrow_exception(own);
+		}
+	}
+
+	/*Sortuje [first, last) jak std::sort (bez gwarancji stabilności)
+	  Złożoność: O(n log n) porównań, O(n log n / workers) czasu dla dużych n */
+	template<typename It, typename Less>
+	void sort(It first, It last, Less less) const {
+		sortRange(first, last, less, workers);
+	}
+
+private:
+	std::size_t workers;
+	std::size_t grain;
+
+	template<typename F>
+	static void run(F &f, std::exception_ptr &failure) noexcept {
+		try {
+			f();
+		}
+		catch (...) {
+			failure = std::current_exception();
+		}
+	}
+
+	/*Dzieli zakres na dwie połowy sortowane przez połowy dostępnych wątków
+	  i scala je */
+	template<typename It, typename Less>
+	void sortRange(It first, It last, Less less, std::size_t threads) const {
+		std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+		if (threads < 2 || n < 2 * grain) {
+			std::sort(first, last, less);
+			return;
+		}
+		It middle = first;
+		std::advance(middle, n / 2);
+		invoke([&]() {
+			sortRange(first, middle, less, threads / 2);
+		}, [&]() {
+			sortRange(middle, last, less, threads - threads / 2);
+		});
+		std::inplace_merge(first, middle, last, less);
+	}
+};
+
+#endif //PARALLELQUEUE_HH
@@ -1,9 +1,23 @@
 #ifndef PRIORITYQUEUE_HH
 #define PRIORITYQUEUE_HH
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
-#include <set>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <new>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 struct PriorityQueueNotFoundException : public std::exception {
 	virtual const char *what() const noexcept {
@@ -17,313 +31,2883 @@ struct PriorityQueueEmptyException : public std::exception {
 	}
 };
 
+struct PriorityQueueFileException : public std::exception {
+	virtual const char *what() const noexcept {
+		return "PriorityQueueFileException";
+	}
+};
+
+/*Format pliku zapisywanego przez PriorityQueue::save: nagłówek, od
+  recordsOffset count rekordów (klucz, wartość) posortowanych jak drzewo
+  kluczy, a od orderOffset count 64-bitowych numerów rekordów w porządku
+  wartości. Liczby są zapisane w kolejności bajtów maszyny, a rekordy są
+  wyrównane, więc plik można odwzorować w pamięć i czytać bez rozpakowywania
+  (MappedPriorityQueue). */
+struct PriorityQueueFileHeader {
+	char magic[8];
+	std::uint64_t keySize;
+	std::uint64_t valueSize;
+	std::uint64_t recordSize;
+	std::uint64_t count;
+	std::uint64_t recordsOffset;
+	std::uint64_t orderOffset;
+
+	static const char *expectedMagic() noexcept {
+		return "PQUEUE1";
+	}
+
+	/*Nagłówek pliku dla count par typów K i V */
+	template<typename K, typename V, typename Record>
+	static PriorityQueueFileHeader describe(std::uint64_t count) noexcept {
+		PriorityQueueFileHeader header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, expectedMagic(), sizeof(header.magic));
+		header.keySize = sizeof(K);
+		header.valueSize = sizeof(V);
+		header.recordSize = sizeof(Record);
+		header.count = count;
+		header.recordsOffset = 64;
+		header.orderOffset = (header.recordsOffset + count * sizeof(Record) + 7) / 8 * 8;
+		return header;
+	}
+
+	/*Czy nagłówek opisuje plik par typów K i V o długości fileSize; pola
+	  nagłówka mogą być dowolne, więc granice są sprawdzane bez przepełnień:
+	  count jest najpierw ograniczany długością pliku */
+	template<typename K, typename V, typename Record>
+	bool matches(std::uint64_t fileSize) const noexcept {
+		PriorityQueueFileHeader expected = describe<K, V, Record>(count);
+		if (std::memcmp(magic, expected.magic, sizeof(magic)) != 0
+		    || keySize != expected.keySize || valueSize != expected.valueSize
+		    || recordSize != expected.recordSize || recordsOffset != expected.recordsOffset
+		    || fileSize < recordsOffset
+		    || count > (fileSize - recordsOffset) / (sizeof(Record) + sizeof(std::uint64_t))) {
+			return false;
+		}
+		return orderOffset == expected.orderOffset && orderOffset <= fileSize
+		       && count <= (fileSize - orderOffset) / sizeof(std::uint64_t);
+	}
+};
+
+/*Rekord pliku; K i V muszą być trywialnie kopiowalne */
 template<typename K, typename V>
+struct PriorityQueueFileRecord {
+	K first;
+	V second;
+};
+
+/*Wynik operacji, która może nie zwrócić wartości (np. na pustej kolejce);
+  odpowiednik std::optional dostępny w C++11 */
+template<typename T>
+class PriorityQueueOptional {
+public:
+	PriorityQueueOptional() noexcept : engaged(false) {
+	}
+
+	PriorityQueueOptional(const PriorityQueueOptional &other) : engaged(false) {
+		if (other.engaged) {
+			emplace(*other);
+		}
+	}
+
+	PriorityQueueOptional(PriorityQueueOptional &&other) noexcept(std::is_nothrow_move_constructible<T>::value)
+		: engaged(false) {
+		if (other.engaged) {
+			emplace(std::move(*other));
+		}
+	}
+
+	PriorityQueueOptional &operator=(PriorityQueueOptional other) {
+		reset();
+		if (other.engaged) {
+			emplace(std::move(*other));
+		}
+		return *this;
+	}
+
+	~PriorityQueueOptional() {
+		reset();
+	}
+
+	/*Metoda tworząca przechowywaną wartość z argumentów args
+	  Exception safety: basic (po wyjątku obiekt jest pusty) */
+	template<typename... Args>
+	void emplace(Args &&... args) {
+		reset();
+		new (&storage) T(std::forward<Args>(args)...);
+		engaged = true;
+	}
+
+	void reset() noexcept {
+		if (engaged) {
+			get().~T();
+			engaged = false;
+		}
+	}
+
+	bool hasValue() const noexcept {
+		return engaged;
+	}
+
+	explicit operator bool() const noexcept {
+		return engaged;
+	}
+
+	/*Metoda zwracająca przechowywaną wartość; rzuca PriorityQueueEmptyException,
+	  gdy obiekt jest pusty */
+	T &value() {
+		if (!engaged) {
+			throw PriorityQueueEmptyException();
+		}
+		return get();
+	}
+
+	const T &value() const {
+		if (!engaged) {
+			throw PriorityQueueEmptyException();
+		}
+		return get();
+	}
+
+	T &operator*() noexcept {
+		return get();
+	}
+
+	const T &operator*() const noexcept {
+		return get();
+	}
+
+	T *operator->() noexcept {
+		return &get();
+	}
+
+	const T *operator->() const noexcept {
+		return &get();
+	}
+
+private:
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+	bool engaged;
+
+	T &get() noexcept {
+		return *reinterpret_cast<T *>(&storage);
+	}
+
+	const T &get() const noexcept {
+		return *reinterpret_cast<const T *>(&storage);
+	}
+};
+
+/*Polityki wyszukiwania klucza (czwarty parametr PriorityQueue). Domyślnie klucz
+  jest wyszukiwany w drzewie kluczy w O(log size()). PriorityQueueHashLookup
+  utrzymuje dodatkowo tablicę haszującą z adresowaniem otwartym, w której
+  klucz jest znajdowany średnio w O(1); wymaga haszu (domyślnie std::hash<K>),
+  który nie rzuca wyjątków, oraz operatora == dla kluczy, zgodnego z <. */
+struct PriorityQueueTreeLookup {
+};
+
+template<typename Hash = void>
+struct PriorityQueueHashLookup {
+};
+
+/*Polityki wykonania operacji zbiorczych (konstruktor z zakresu i merge
+  z polityką jako pierwszym argumentem). Polityka dziedziczy po
+  PriorityQueueExecutionPolicy i ma metody:
+    void invoke(F f, G g) const - wykonuje f i g (być może równolegle) i czeka
+      na oba; wyjątek zgłoszony przez któreś z nich jest zgłaszany dalej,
+    void sort(It first, It last, Less less) const - jak std::sort.
+  PriorityQueueSequential wykonuje wszystko po kolei w wywołującym wątku;
+  PriorityQueueParallel z parallelqueue.hh używa wielu wątków. */
+struct PriorityQueueExecutionPolicy {
+};
+
+struct PriorityQueueSequential : PriorityQueueExecutionPolicy {
+	template<typename F, typename G>
+	void invoke(F &&f, G &&g) const {
+		f();
+		g();
+	}
+
+	template<typename It, typename Less>
+	void sort(It first, It last, Less less) const {
+		std::sort(first, last, less);
+	}
+};
+
+/*Zdarzenia zgłaszane polityce statystyk */
+enum class PriorityQueueEvent : unsigned {
+	insert,
+	deleteMin,
+	deleteMax,
+	changeHit,
+	changeMiss,
+	erase,
+	merge,
+	split,
+	allocate
+};
+
+const std::size_t PriorityQueueEventCount = 9;
+const std::size_t PriorityQueueLatencyBuckets = 32;
+
+/*Statystyki kolejki zwracane przez PriorityQueue::stats(). latency[e][b] to
+  liczba zdarzeń e, które trwały od 2^b do 2^(b+1) - 1 nanosekund (tylko gdy
+  polityka mierzy czas). */
+struct PriorityQueueStats {
+	std::uint64_t events[PriorityQueueEventCount] = {};
+	std::uint64_t latency[PriorityQueueEventCount][PriorityQueueLatencyBuckets] = {};
+	std::size_t size = 0;
+	std::size_t peakSize = 0;
+	std::size_t bytes = 0;
+	std::size_t peakBytes = 0;
+
+	std::uint64_t count(PriorityQueueEvent event) const noexcept {
+		return events[static_cast<unsigned>(event)];
+	}
+};
+
+/*Polityki statystyk (piąty parametr PriorityQueue). Polityka to klasa
+  z metodami:
+    mark start() noexcept - wywoływana na początku operacji,
+    void record(PriorityQueueEvent event, std::size_t count, std::size_t size, mark started) noexcept
+      - wywoływana po udanej operacji, gdzie count to liczba zdarzeń (np. par
+        zdjętych przez popMin), a size to rozmiar kolejki po operacji,
+    void collect(PriorityQueueStats &stats) const noexcept - dla stats().
+  Domyślna PriorityQueueNoStats nic nie robi i kompilator usuwa jej wywołania.
+  Liczniki i histogramy są w queuestats.hh; własna polityka, np. wysyłająca
+  dane do systemu metryk, może dziedziczyć po jednej z nich i rozszerzać record.
+  Statystyki należą do obiektu kolejki: swap, przypisanie i merge ich nie
+  przenoszą, a kopia zaczyna od zera. */
+struct PriorityQueueNoStats {
+	int start() const noexcept {
+		return 0;
+	}
+
+	void record(PriorityQueueEvent, std::size_t, std::size_t, int) noexcept {
+	}
+
+	void collect(PriorityQueueStats &) const noexcept {
+	}
+};
+
+/*Polityki rozstrzygania remisów w porządku wartości (szósty parametr
+  PriorityQueue). Domyślnie pary o równych wartościach są uporządkowane według
+  kluczy. Z PriorityQueueFifoTieBreak kolejka nadaje każdej parze numer
+  wstawienia, trzymany w węźle, i pary o równych wartościach są uporządkowane
+  według niego: minValue, deleteMin i pozostałe operacje na skrajnych parach
+  wybierają spośród nich parę wstawioną najwcześniej. Pary o równych kluczach
+  i wartościach są tak samo uporządkowane w porządku kluczy, więc changeValue
+  dla klucza występującego wiele razy zmienia najwcześniej wstawioną parę
+  o najmniejszej wartości. changeValue nadaje parze nowy numer (para staje
+  za parami o tej samej wartości), a merge i wstawianie zakresu nadają
+  parom przenoszonym nowe numery, tak jakby zostały wstawione po parach
+  kolejki, w ich dotychczasowej kolejności. Węzeł jest większy o 8 bajtów. */
+struct PriorityQueueKeyTieBreak {
+};
+
+struct PriorityQueueFifoTieBreak {
+};
+
+template<typename K, typename V, typename Alloc = std::allocator<std::pair<const K, V>>,
+         typename Lookup = PriorityQueueTreeLookup, typename Stats = PriorityQueueNoStats,
+         typename TieBreak = PriorityQueueKeyTieBreak>
 class PriorityQueue {
 private:
-	using key_shared = std::shared_ptr<K>;
-	using value_shared = std::shared_ptr<V>;
-	using key_value = std::pair<key_shared, value_shared>;
-	using value_key = std::pair<value_shared, key_shared>;
+	struct node;
+
+	template<std::size_t... I>
+	struct indices {
+	};
+
+	template<std::size_t N, std::size_t... I>
+	struct make_indices : make_indices<N - 1, N - 1, I...> {
+	};
+
+	template<std::size_t... I>
+	struct make_indices<0, I...> {
+		using type = indices<I...>;
+	};
+
+	/*Zaczep węzła w jednym z drzew (porządek po kluczach albo po wartościach).
+	  Każda para (klucz, wartość) żyje w dokładnie jednym węźle, który jest
+	  jednocześnie wpięty w oba drzewa. */
+	struct hook {
+		node *parent;
+		node *left;
+		node *right;
+	};
+
+	/*Numer wstawienia pary z PriorityQueueFifoTieBreak; w domyślnym trybie
+	  węzeł nie ma tego pola */
+	struct arrival {
+		std::uint64_t sequence;
+	};
+
+	struct no_arrival {
+	};
+
+	static const bool stable = std::is_same<TieBreak, PriorityQueueFifoTieBreak>::value;
+
+	using arrival_base = typename std::conditional<stable, arrival, no_arrival>::type;
+
+	/*Klucz i wartość są przechowywane w węźle bezpośrednio. Priorytet ma 32 bity,
+	  gdy dzięki temu węzeł jest mniejszy (np. K = int, V = double), a 64 bity
+	  w przeciwnym razie; do drzewca 32 bity losowego priorytetu w zupełności
+	  wystarczają, a powtórzenia priorytetów nie psują poprawności. */
+	template<typename P>
+	struct layout : arrival_base {
+		hook byKey;
+		hook byValue;
+		P priority;
+		K key;
+		V value;
+	};
+
+	using priority_type = typename std::conditional<(sizeof(layout<std::uint32_t>) < sizeof(layout<std::uint64_t>)),
+	                                                std::uint32_t, std::uint64_t>::type;
+
+	/*Pola są ułożone tak jak w layout: zaczepy i priorytet przed parą, żeby
+	  wypełnienie do wyrównania powstawało co najwyżej między kluczem a wartością */
+	struct node : arrival_base {
+		hook byKey;
+		hook byValue;
+		priority_type priority;
+		K key;
+		V value;
+
+		template<typename KArg, typename VArg>
+		node(priority_type p, KArg &&k, VArg &&v)
+			: priority(p), key(std::forward<KArg>(k)), value(std::forward<VArg>(v)) {
+		}
+
+		template<typename... KArgs, typename... VArgs>
+		node(priority_type p, std::piecewise_construct_t, std::tuple<KArgs...> k, std::tuple<VArgs...> v)
+			: node(p, k, v, typename make_indices<sizeof...(KArgs)>::type(),
+			       typename make_indices<sizeof...(VArgs)>::type()) {
+		}
+
+	private:
+		template<typename... KArgs, typename... VArgs, std::size_t... KI, std::size_t... VI>
+		node(priority_type p, std::tuple<KArgs...> &k, std::tuple<VArgs...> &v, indices<KI...>, indices<VI...>)
+			: priority(p), key(std::get<KI>(std::move(k))...), value(std::get<VI>(std::move(v))...) {
+		}
+	};
+
+	/*Drzewo typu treap: porządek BST według komparatora, kopiec według
+	  priorytetu węzła. first i last pozwalają na dostęp do skrajnych
+	  elementów w O(1). */
+	struct tree {
+		node *root = nullptr;
+		node *first = nullptr;
+		node *last = nullptr;
+	};
+
+	using key_hook = std::integral_constant<hook node::*, &node::byKey>;
+	using value_hook = std::integral_constant<hook node::*, &node::byValue>;
+
+	template<typename T>
+	using rebind_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+	using node_allocator = rebind_alloc<node>;
+	using node_traits = std::allocator_traits<node_allocator>;
+	/*Tymczasowe bufory (porządki węzłów, mapy kopii itp.) korzystają
+	  z std::allocator, a nie z Alloc: alokator typu areny nie oddawałby ich
+	  pamięci przed zwolnieniem całej areny */
+	using node_vector = std::vector<node *>;
+
+	/*Indeks kluczy dla PriorityQueueTreeLookup: klucze są wyszukiwane w drzewie */
+	class treeIndex {
+	public:
+		explicit treeIndex(const node_allocator &) noexcept {
+		}
+
+		void reserve(std::size_t) noexcept {
+		}
+
+		void add(node *) noexcept {
+		}
+
+		void remove(node *) noexcept {
+		}
+
+		void clear() noexcept {
+		}
+
+		void swap(treeIndex &) noexcept {
+		}
+	};
+
+	/*Tablica haszująca z adresowaniem otwartym i liniowym próbkowaniem,
+	  zawierająca wszystkie węzły kolejki; usuwanie przesuwa kolejne wpisy
+	  wstecz, więc tablica nie potrzebuje znaczników usunięcia. Pamięć jest
+	  przydzielana tylko w reserve, a add i remove nie rzucają wyjątków. */
+	template<typename Hash>
+	class hashIndex {
+	public:
+		explicit hashIndex(const node_allocator &allocator)
+			: slots(rebind_alloc<slot>(allocator)) {
+		}
+
+		/*Zapewnia miejsce na n węzłów
+		  Exception safety: strong */
+		void reserve(std::size_t n) {
+			if (2 * n <= slots.size()) {
+				return;
+			}
+			std::size_t capacity = 16;
+			while (capacity < 2 * n) {
+				capacity *= 2;
+			}
+			std::vector<slot, rebind_alloc<slot>> grown(capacity, slot(), slots.get_allocator());
+			grown.swap(slots);
+			for (slot &entry : grown) {
+				if (entry.target) {
+					place(entry);
+				}
+			}
+		}
+
+		void add(node *x) noexcept {
+			place(slot{x, Hash()(x->key)});
+		}
+
+		void remove(node *x) noexcept {
+			std::size_t mask = slots.size() - 1;
+			std::size_t i = Hash()(x->key) & mask;
+			while (slots[i].target != x) {
+				i = (i + 1) & mask;
+			}
+			for (std::size_t j = (i + 1) & mask; slots[j].target; j = (j + 1) & mask) {
+				std::size_t home = slots[j].hash & mask;
+				// wpis j może zająć dziurę i, jeśli jego miejsce docelowe nie leży
+				// cyklicznie w przedziale (i, j]
+				if ((i <= j) ? (home <= i || home > j) : (home <= i && home > j)) {
+					slots[i] = slots[j];
+					i = j;
+				}
+			}
+			slots[i].target = nullptr;
+		}
+
+		/*Dowolny węzeł o kluczu key albo nullptr */
+		node *find(const K &key) const {
+			if (slots.empty()) {
+				return nullptr;
+			}
+			std::size_t mask = slots.size() - 1;
+			std::size_t hash = Hash()(key);
+			for (std::size_t i = hash & mask; slots[i].target; i = (i + 1) & mask) {
+				if (slots[i].hash == hash && slots[i].target->key == key) {
+					return slots[i].target;
+				}
+			}
+			return nullptr;
+		}
+
+		void clear() noexcept {
+			for (slot &entry : slots) {
+				entry.target = nullptr;
+			}
+		}
+
+		void swap(hashIndex &other) noexcept {
+			slots.swap(other.slots);
+		}
+
+	private:
+		struct slot {
+			node *target;
+			std::size_t hash;
+		};
+
+		std::vector<slot, rebind_alloc<slot>> slots;
+
+		void place(const slot &entry) noexcept {
+			std::size_t mask = slots.size() - 1;
+			std::size_t i = entry.hash & mask;
+			while (slots[i].target) {
+				i = (i + 1) & mask;
+			}
+			slots[i] = entry;
+		}
+	};
+
+	template<typename L>
+	struct lookup_traits {
+		using index = treeIndex;
+	};
+
+	template<typename Hash>
+	struct lookup_traits<PriorityQueueHashLookup<Hash>> {
+		using index = hashIndex<typename std::conditional<std::is_void<Hash>::value, std::hash<K>, Hash>::type>;
+	};
+
+	using key_index = typename lookup_traits<Lookup>::index;
+	static const bool hashed = !std::is_same<key_index, treeIndex>::value;
+
+	template<typename T, typename = void>
+	struct nothrow_hashable : std::false_type {
+	};
+
+	template<typename T>
+	struct nothrow_hashable<T, decltype(void(std::hash<T>()(std::declval<const T &>())))>
+		: std::integral_constant<bool, noexcept(std::hash<T>()(std::declval<const T &>()))> {
+	};
+
+	/*Skrót zawartości jest utrzymywany tylko wtedy, gdy std::hash dla K i V
+	  istnieje i nie zgłasza wyjątków */
+	static const bool digested = nothrow_hashable<K>::value && nothrow_hashable<V>::value;
+
+	/*Węzeł wypieranej pary może przyjąć nową parę bez przydzielania pamięci,
+	  gdy przypisania przenoszące K i V nie zgłaszają wyjątków */
+	static const bool recyclable = std::is_nothrow_move_assignable<K>::value && std::is_nothrow_move_assignable<V>::value;
+
+	/*Ogranicza szablony przyjmujące zakres do iteratorów po parach (klucz, wartość) */
+	template<typename InputIt>
+	using pair_iterator = decltype((*std::declval<InputIt &>()).first, (*std::declval<InputIt &>()).second, void());
+
+	template<typename Policy>
+	using execution_policy = typename std::enable_if<std::is_base_of<PriorityQueueExecutionPolicy, Policy>::value>::type;
+
+	node_allocator alloc;
+	/*Pusta polityka statystyk zajmuje bajt wypełnienia za pustym alokatorem */
+	Stats statistics;
+	tree containerKV;
+	tree containerVK;
+	std::size_t elements = 0;
+	/*Największa dozwolona liczba par (patrz setCapacity) */
+	std::size_t limit = std::numeric_limits<std::size_t>::max();
+	std::uint64_t seed = 0;
+	/*Suma skrótów wszystkich par (modulo 2^64), niezależna od ich kolejności
+	  i aktualizowana przy każdym wpięciu i wypięciu węzła; równe kolejki mają
+	  równe skróty, więc operator== zwykle odrzuca różne kolejki w O(1) */
+	std::uint64_t digest = 0;
+	key_index keyIndex{alloc};
+	/*Migawka współdzieląca węzły z kolejką (patrz snapshot()); dopóki jest
+	  ustawiona, węzły i indeks kluczy należą do niej, a drzewa kolejki
+	  wskazują na te same węzły */
+	std::shared_ptr<PriorityQueue> frozen;
+
+	using stats_mark = decltype(std::declval<const Stats &>().start());
+
+	void record(PriorityQueueEvent event, std::size_t count, stats_mark started) noexcept {
+		statistics.record(event, count, elements, started);
+	}
+
+	/*Priorytety są deterministyczne (a 64-bitowe także różne w obrębie jednej
+	  kolejki), więc kształt drzew zależy wyłącznie od historii operacji na niej */
+	priority_type nextPriority() noexcept {
+		return static_cast<priority_type>(mix(++seed));
+	}
+
+	static std::uint64_t mix(std::uint64_t x) noexcept {
+		x *= 0x9e3779b97f4a7c15ULL;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+		return x ^ (x >> 31);
+	}
+
+	/*Składnik skrótu zawartości dla pary z węzła x */
+	static std::uint64_t pairDigest(const node *x) noexcept {
+		return pairDigest(x, std::integral_constant<bool, digested>());
+	}
+
+	static std::uint64_t pairDigest(const node *x, std::true_type) noexcept {
+		return mix(mix(std::hash<K>()(x->key) + 1) + std::hash<V>()(x->value));
+	}
+
+	static std::uint64_t pairDigest(const node *, std::false_type) noexcept {
+		return 0;
+	}
+
+	static bool lessKV(const K &k1, const V &v1, const K &k2, const V &v2) {
+		if (k1 < k2) {
+			return true;
+		}
+		if (k2 < k1) {
+			return false;
+		}
+		return v1 < v2;
+	}
+
+	static bool lessVK(const V &v1, const K &k1, const V &v2, const K &k2) {
+		if (v1 < v2) {
+			return true;
+		}
+		if (v2 < v1) {
+			return false;
+		}
+		return k1 < k2;
+	}
+
+	static void stamp(node *x, std::uint64_t sequence) noexcept {
+		stamp(x, sequence, std::integral_constant<bool, stable>());
+	}
+
+	static void stamp(node *x, std::uint64_t sequence, std::true_type) noexcept {
+		x->sequence = sequence;
+	}
+
+	static void stamp(node *, std::uint64_t, std::false_type) noexcept {
+	}
+
+	static std::uint64_t sequenceOf(const node *x) noexcept {
+		return sequenceOf(x, std::integral_constant<bool, stable>());
+	}
+
+	static std::uint64_t sequenceOf(const node *x, std::true_type) noexcept {
+		return x->sequence;
+	}
+
+	static std::uint64_t sequenceOf(const node *, std::false_type) noexcept {
+		return 0;
+	}
+
+	/*Czy para (value, key), wstawiana jako najnowsza, leży w porządku wartości
+	  przed węzłem x; z PriorityQueueFifoTieBreak rozstrzyga sama wartość */
+	static bool precedesVK(const V &value, const K &key, const node *x) {
+		return stable ? value < x->value : lessVK(value, key, x->value, x->key);
+	}
+
+	static bool nodeLessKV(const node *a, const node *b) {
+		if (!stable) {
+			return lessKV(a->key, a->value, b->key, b->value);
+		}
+		if (lessKV(a->key, a->value, b->key, b->value)) {
+			return true;
+		}
+		if (lessKV(b->key, b->value, a->key, a->value)) {
+			return false;
+		}
+		return sequenceOf(a) < sequenceOf(b);
+	}
+
+	static bool nodeLessVK(const node *a, const node *b) {
+		if (!stable) {
+			return lessVK(a->value, a->key, b->value, b->key);
+		}
+		if (a->value < b->value) {
+			return true;
+		}
+		if (b->value < a->value) {
+			return false;
+		}
+		return sequenceOf(a) < sequenceOf(b);
+	}
+
+	template<typename H>
+	static hook &links(node *x) noexcept {
+		return x->*H::value;
+	}
+
+	template<typename H>
+	static node *leftmost(node *x) noexcept {
+		while (links<H>(x).left) {
+			x = links<H>(x).left;
+		}
+		return x;
+	}
+
+	template<typename H>
+	static node *rightmost(node *x) noexcept {
+		while (links<H>(x).right) {
+			x = links<H>(x).right;
+		}
+		return x;
+	}
+
+	template<typename H>
+	static node *next(node *x) noexcept {
+		if (links<H>(x).right) {
+			return leftmost<H>(links<H>(x).right);
+		}
+		node *p = links<H>(x).parent;
+		while (p && links<H>(p).right == x) {
+			x = p;
+			p = links<H>(p).parent;
+		}
+		return p;
+	}
+
+	template<typename H>
+	static node *prev(node *x) noexcept {
+		if (links<H>(x).left) {
+			return rightmost<H>(links<H>(x).left);
+		}
+		node *p = links<H>(x).parent;
+		while (p && links<H>(p).left == x) {
+			x = p;
+			p = links<H>(p).parent;
+		}
+		return p;
+	}
+
+	template<typename H>
+	static void replaceChild(tree &t, node *p, node *from, node *to) noexcept {
+		if (!p) {
+			t.root = to;
+		}
+		else if (links<H>(p).left == from) {
+			links<H>(p).left = to;
+		}
+		else {
+			links<H>(p).right = to;
+		}
+	}
+
+	/*Rotacja podnosząca x o jeden poziom; zachowuje porządek in-order */
+	template<typename H>
+	static void rotateUp(tree &t, node *x) noexcept {
+		node *p = links<H>(x).parent;
+		node *g = links<H>(p).parent;
+		if (links<H>(p).left == x) {
+			links<H>(p).left = links<H>(x).right;
+			if (links<H>(x).right) {
+				links<H>(links<H>(x).right).parent = p;
+			}
+			links<H>(x).right = p;
+		}
+		else {
+			links<H>(p).right = links<H>(x).left;
+			if (links<H>(x).left) {
+				links<H>(links<H>(x).left).parent = p;
+			}
+			links<H>(x).left = p;
+		}
+		links<H>(p).parent = x;
+		links<H>(x).parent = g;
+		replaceChild<H>(t, g, p, x);
+	}
+
+	/*Wstawia węzeł x bezpośrednio przed pos (na koniec, gdy pos == nullptr).
+	  Nie wykonuje żadnych porównań, więc nie zgłasza wyjątków. */
+	template<typename H>
+	static void linkBefore(tree &t, node *x, node *pos) noexcept {
+		hook &hx = links<H>(x);
+		hx.left = hx.right = hx.parent = nullptr;
+		if (!t.root) {
+			t.root = t.first = t.last = x;
+			return;
+		}
+		if (!pos) {
+			links<H>(t.last).right = x;
+			hx.parent = t.last;
+			t.last = x;
+		}
+		else if (!links<H>(pos).left) {
+			links<H>(pos).left = x;
+			hx.parent = pos;
+			if (t.first == pos) {
+				t.first = x;
+			}
+		}
+		else {
+			node *p = rightmost<H>(links<H>(pos).left);
+			links<H>(p).right = x;
+			hx.parent = p;
+		}
+		while (hx.parent && links<H>(x).parent->priority < x->priority) {
+			rotateUp<H>(t, x);
+		}
+	}
+
+	/*Wypina węzeł x z drzewa, nie zwalniając go */
+	template<typename H>
+	static void unlink(tree &t, node *x) noexcept {
+		if (t.first == x) {
+			t.first = next<H>(x);
+		}
+		if (t.last == x) {
+			t.last = prev<H>(x);
+		}
+		hook &hx = links<H>(x);
+		while (hx.left && hx.right) {
+			if (hx.left->priority < hx.right->priority) {
+				rotateUp<H>(t, hx.right);
+			}
+			else {
+				rotateUp<H>(t, hx.left);
+			}
+		}
+		node *child = hx.left ? hx.left : hx.right;
+		if (child) {
+			links<H>(child).parent = hx.parent;
+		}
+		replaceChild<H>(t, hx.parent, x, child);
+	}
+
+	/*Buduje drzewo z węzłów podanych w porządku rosnącym
+	  Złożoność: O(n) (kopiec budowany po prawym grzbiecie drzewa) */
+	template<typename H>
+	static void build(tree &t, node *const *seq, std::size_t n) noexcept {
+		t = tree();
+		for (std::size_t i = 0; i < n; i++) {
+			node *x = seq[i];
+			node *y = t.last;
+			node *child = nullptr;
+			while (y && y->priority < x->priority) {
+				child = y;
+				y = links<H>(y).parent;
+			}
+			hook &hx = links<H>(x);
+			hx.left = child;
+			hx.right = nullptr;
+			hx.parent = y;
+			if (child) {
+				links<H>(child).parent = x;
+			}
+			if (y) {
+				links<H>(y).right = x;
+			}
+			else {
+				t.root = x;
+			}
+			t.last = x;
+		}
+		if (n) {
+			t.first = seq[0];
+		}
+	}
+
+	/*Zwraca skrajny węzeł drzewa wartości wskazany przez tree::first albo
+	  tree::last, które są utrzymywane przy każdym wpięciu i wypięciu; dostęp
+	  do skrajnej pary to jeden odczyt wskaźnika bez sprawdzania size(), a rzucanie
+	  wyjątku jest wydzielone z gorącej ścieżki */
+	static node *nonEmpty(node *x) {
+		if (!x) {
+			throwEmpty();
+		}
+		return x;
+	}
+
+	[[noreturn]] static void throwEmpty() {
+		throw PriorityQueueEmptyException();
+	}
+
+	/*Pierwszy węzeł, którego para (klucz, wartość) jest większa od podanej;
+	  nowo wstawiana para trafia za wszystkie równe, więc w trybie FIFO jest to
+	  też miejsce pary o największym numerze wstawienia */
+	node *upperKV(const K &key, const V &value) const {
+		node *pos = nullptr;
+		for (node *x = containerKV.root; x;) {
+			if (lessKV(key, value, x->key, x->value)) {
+				pos = x;
+				x = x->byKey.left;
+			}
+			else {
+				x = x->byKey.right;
+			}
+		}
+		return pos;
+	}
+
+	/*Pierwszy węzeł, przed którym w porządku wartości leży nowo wstawiana para
+	  (wartość, klucz) */
+	node *upperVK(const V &value, const K &key) const {
+		node *pos = nullptr;
+		for (node *x = containerVK.root; x;) {
+			if (precedesVK(value, key, x)) {
+				pos = x;
+				x = x->byValue.left;
+			}
+			else {
+				x = x->byValue.right;
+			}
+		}
+		return pos;
+	}
+
+	/*Pierwszy węzeł drzewa t większy od węzła target spoza drzewa */
+	template<typename H, typename Less>
+	static node *upperNode(const tree &t, const node *target, Less less) {
+		node *pos = nullptr;
+		for (node *x = t.root; x;) {
+			if (less(target, x)) {
+				pos = x;
+				x = links<H>(x).left;
+			}
+			else {
+				x = links<H>(x).right;
+			}
+		}
+		return pos;
+	}
+
+	/*Pierwszy węzeł o kluczu nie mniejszym niż key */
+	node *lowerKey(const K &key) const {
+		node *pos = nullptr;
+		for (node *x = containerKV.root; x;) {
+			if (x->key < key) {
+				x = x->byKey.right;
+			}
+			else {
+				pos = x;
+				x = x->byKey.left;
+			}
+		}
+		return pos;
+	}
+
+	/*Pierwszy węzeł o wartości nie mniejszej niż value */
+	node *lowerValue(const V &value) const {
+		node *pos = nullptr;
+		for (node *x = containerVK.root; x;) {
+			if (x->value < value) {
+				x = x->byValue.right;
+			}
+			else {
+				pos = x;
+				x = x->byValue.left;
+			}
+		}
+		return pos;
+	}
+
+	/*Pierwszy węzeł o kluczu key albo nullptr, gdy takiego nie ma */
+	node *findKey(const K &key) const {
+		return findKey(key, std::integral_constant<bool, hashed>());
+	}
+
+	node *findKey(const K &key, std::true_type) const {
+		node *x = (frozen ? frozen->keyIndex : keyIndex).find(key);
+		if (x) {
+			for (node *p = prev<key_hook>(x); p && !(p->key < key); p = prev<key_hook>(x)) {
+				x = p;
+			}
+		}
+		return x;
+	}
+
+	node *findKey(const K &key, std::false_type) const {
+		node *pos = lowerKey(key);
+		if (pos && key < pos->key) {
+			return nullptr;
+		}
+		return pos;
+	}
+
+	/*Wymaga wcześniejszego keyIndex.reserve(size() + 1) */
+	void linkNode(node *x, node *posKV, node *posVK) noexcept {
+		linkBefore<key_hook>(containerKV, x, posKV);
+		linkBefore<value_hook>(containerVK, x, posVK);
+		keyIndex.add(x);
+		digest += pairDigest(x);
+		elements++;
+	}
+
+	void unlinkNode(node *x) noexcept {
+		unlink<key_hook>(containerKV, x);
+		unlink<value_hook>(containerVK, x);
+		keyIndex.remove(x);
+		digest -= pairDigest(x);
+		elements--;
+	}
+
+	/*Przestawia węzeł x na miejsce odpowiadające nowej wartości replacement
+	  i przenosi ją do węzła; porównania wykonują się przed jakąkolwiek zmianą.
+	  Węzeł zostaje na miejscu w drzewie, w którym jego pozycja się nie zmienia,
+	  np. w drzewie kluczy, gdy to jedyna para o tym kluczu. */
+	void reposition(node *x, V &replacement) {
+		node *before = prev<key_hook>(x);
+		node *after = next<key_hook>(x);
+		bool alone = (!before || before->key < x->key) && (!after || x->key < after->key);
+		node *posKV = alone ? after : upperKV(x->key, replacement);
+		node *posVK = upperVK(replacement, x->key);
+		bool movedKV = posKV != x && posKV != after;
+		bool movedVK = posVK != x && posVK != next<value_hook>(x);
+		if (movedKV) {
+			unlink<key_hook>(containerKV, x);
+		}
+		if (movedVK) {
+			unlink<value_hook>(containerVK, x);
+		}
+		digest -= pairDigest(x);
+		x->value = std::move(replacement);
+		digest += pairDigest(x);
+		stamp(x, ++seed);
+		if (movedKV) {
+			linkBefore<key_hook>(containerKV, x, posKV);
+		}
+		if (movedVK) {
+			linkBefore<value_hook>(containerVK, x, posVK);
+		}
+	}
+
+	/*Jedyne miejsce przydzielające pamięć na parę; wszystko idzie przez alloc.
+	  Numerem wstawienia węzła jest bieżący seed, zwiększany przez nextPriority(). */
+	template<typename... Args>
+	node *createNode(priority_type priority, Args &&... args) {
+		stats_mark started = statistics.start();
+		node *x = node_traits::allocate(alloc, 1);
+		try {
+			node_traits::construct(alloc, x, priority, std::forward<Args>(args)...);
+		}
+		catch (...) {
+			node_traits::deallocate(alloc, x, 1);
+			throw;
+		}
+		stamp(x, seed);
+		record(PriorityQueueEvent::allocate, 1, started);
+		return x;
+	}
+
+	void destroyNode(node *x) noexcept {
+		node_traits::destroy(alloc, x);
+		node_traits::deallocate(alloc, x, 1);
+	}
+
+	void destroy(node *x) noexcept {
+		while (x) {
+			destroy(x->byKey.left);
+			node *right = x->byKey.right;
+			destroyNode(x);
+			x = right;
+		}
+	}
+
+	/*Zamienia całą zawartość razem z alokatorem, niezależnie od
+	  propagate_on_container_swap; używane tylko wewnętrznie */
+	void swapAll(PriorityQueue &queue) noexcept {
+		using std::swap;
+		swap(alloc, queue.alloc);
+		swap(containerKV, queue.containerKV);
+		swap(containerVK, queue.containerVK);
+		swap(elements, queue.elements);
+		swap(limit, queue.limit);
+		swap(seed, queue.seed);
+		swap(digest, queue.digest);
+		keyIndex.swap(queue.keyIndex);
+		swap(frozen, queue.frozen);
+	}
+
+	/*Kopiuje queue do pustej kolejki *this, zachowując priorytety węzłów;
+	  gdy tracked nie jest pusty, węzeł *tracked z queue jest zastępowany kopią */
+	void copyFrom(const PriorityQueue &queue, node **tracked = nullptr) {
+		node_vector orderKV;
+		node_vector orderVK;
+		std::unordered_map<const node *, node *> clones(queue.size());
+		orderKV.reserve(queue.size());
+		orderVK.reserve(queue.size());
+		keyIndex.reserve(queue.size());
+		try {
+			for (node *x = queue.containerKV.first; x; x = next<key_hook>(x)) {
+				orderKV.push_back(createNode(x->priority, x->key, x->value));
+				stamp(orderKV.back(), sequenceOf(x));
+				clones.emplace(x, orderKV.back());
+			}
+		}
+		catch (...) {
+			for (node *x : orderKV) {
+				destroyNode(x);
+			}
+			throw;
+		}
+		for (node *x = queue.containerVK.first; x; x = next<value_hook>(x)) {
+			orderVK.push_back(clones.find(x)->second);
+		}
+		build<key_hook>(containerKV, orderKV.data(), orderKV.size());
+		build<value_hook>(containerVK, orderVK.data(), orderVK.size());
+		for (node *x : orderKV) {
+			keyIndex.add(x);
+		}
+		elements = queue.elements;
+		seed = queue.seed;
+		digest = queue.digest;
+		if (tracked) {
+			*tracked = clones.find(*tracked)->second;
+		}
+	}
+
+	static std::size_t log2(std::size_t n) noexcept {
+		std::size_t result = 0;
+		for (; n > 1; n >>= 1) {
+			result++;
+		}
+		return result;
+	}
+
+	/*Scala dwa posortowane ciągi węzłów w jeden; przy równych elementach
+	  pierwszeństwo mają węzły z a */
+	template<typename H, typename Less>
+	static void mergeOrder(node *a, node *b, node_vector &out, Less less) {
+		while (a && b) {
+			if (less(b, a)) {
+				out.push_back(b);
+				b = next<H>(b);
+			}
+			else {
+				out.push_back(a);
+				a = next<H>(a);
+			}
+		}
+		for (; a; a = next<H>(a)) {
+			out.push_back(a);
+		}
+		for (; b; b = next<H>(b)) {
+			out.push_back(b);
+		}
+	}
+
+	/*Przepina wszystkie węzły queue do *this, scalając oba porządki liniowo
+	  i budując drzewa od nowa; każdy z porządków może być scalany i budowany
+	  w osobnym wątku polityki policy, bo dotyczy innego zaczepu węzłów;
+	  wymaga równych alokatorów
+	  Złożoność: O(size() + queue.size()) */
+	template<typename Policy>
+	void spliceLinear(PriorityQueue &queue, const Policy &policy) {
+		node_vector orderKV;
+		node_vector orderVK;
+		orderKV.reserve(size() + queue.size());
+		orderVK.reserve(size() + queue.size());
+		keyIndex.reserve(size() + queue.size());
+		policy.invoke([&]() {
+			mergeOrder<key_hook>(containerKV.first, queue.containerKV.first, orderKV, nodeLessKV);
+		}, [&]() {
+			mergeOrder<value_hook>(containerVK.first, queue.containerVK.first, orderVK, nodeLessVK);
+		});
+		for (node *x = queue.containerKV.first; x; x = next<key_hook>(x)) {
+			x->priority = nextPriority();
+			keyIndex.add(x);
+		}
+		queue.keyIndex.clear();
+		policy.invoke([&]() {
+			build<key_hook>(containerKV, orderKV.data(), orderKV.size());
+		}, [&]() {
+			build<value_hook>(containerVK, orderVK.data(), orderVK.size());
+		});
+		elements += queue.elements;
+		digest += queue.digest;
+		queue.containerKV = tree();
+		queue.containerVK = tree();
+		queue.elements = 0;
+		queue.digest = 0;
+	}
+
+	/*Wybiera sposób przepięcia węzłów: gdy jedna z kolejek jest dużo mniejsza,
+	  jej węzły są wstawiane pojedynczo do większej, w przeciwnym razie oba
+	  porządki są scalane liniowo; wymaga równych alokatorów */
+	template<typename Policy = PriorityQueueSequential>
+	void spliceAll(PriorityQueue &queue, const Policy &policy = Policy()) {
+		renumberAfter(queue);
+		std::size_t total = size() + queue.size();
+		std::size_t depth = log2(total) + 1;
+		if (queue.size() * depth < total) {
+			splice(queue);
+		}
+		else if (size() * depth < total) {
+			queue.splice(*this);
+			swapAll(queue);
+			// limit należy do kolejki, a nie do jej zawartości
+			std::swap(limit, queue.limit);
+		}
+		else {
+			spliceLinear(queue, policy);
+		}
+	}
+
+	/*W trybie FIFO nadaje parom queue, w ich kolejności w porządku wartości,
+	  numery wstawienia większe od wszystkich numerów w *this; względna
+	  kolejność węzłów każdej z kolejek się nie zmienia */
+	void renumberAfter(PriorityQueue &queue) noexcept {
+		if (!stable) {
+			return;
+		}
+		std::uint64_t sequence = std::max(seed, queue.seed);
+		for (node *x = queue.containerVK.first; x; x = next<value_hook>(x)) {
+			stamp(x, ++sequence);
+		}
+		seed = sequence;
+		queue.seed = sequence;
+	}
+
+	/*Przepina wszystkie węzły queue do *this, wstawiając je pojedynczo;
+	  wymaga równych alokatorów
+	  Złożoność: O(queue.size() * log (queue.size() + size())) */
+	void splice(PriorityQueue &queue) {
+		std::vector<std::pair<node *, node *>> movesKV, movesVK;
+		movesKV.reserve(queue.size());
+		movesVK.reserve(queue.size());
+		keyIndex.reserve(size() + queue.size());
+		for (node *x = queue.containerKV.first; x; x = next<key_hook>(x)) {
+			movesKV.emplace_back(x, upperNode<key_hook>(containerKV, x, nodeLessKV));
+		}
+		for (node *x = queue.containerVK.first; x; x = next<value_hook>(x)) {
+			movesVK.emplace_back(x, upperNode<value_hook>(containerVK, x, nodeLessVK));
+		}
+		for (auto &move : movesKV) {
+			move.first->priority = nextPriority();
+			linkBefore<key_hook>(containerKV, move.first, move.second);
+			keyIndex.add(move.first);
+		}
+		queue.keyIndex.clear();
+		for (auto &move : movesVK) {
+			linkBefore<value_hook>(containerVK, move.first, move.second);
+		}
+		elements += queue.elements;
+		digest += queue.digest;
+		queue.containerKV = tree();
+		queue.containerVK = tree();
+		queue.elements = 0;
+		queue.digest = 0;
+	}
+
+	tree &treeOf(key_hook) noexcept {
+		return containerKV;
+	}
+
+	tree &treeOf(value_hook) noexcept {
+		return containerVK;
+	}
+
+	/*Odcina od drzewa t węzeł pos i wszystkie następne, zwracając je jako osobne
+	  drzewo: pos jest podnoszony rotacjami do korzenia, odłączany razem z prawym
+	  poddrzewem, a potem opuszczany na miejsce zgodne z priorytetami. Nie
+	  wykonuje porównań, więc nie zgłasza wyjątków.
+	  Złożoność: O(log n) oczekiwana */
+	template<typename H>
+	static tree cutFrom(tree &t, node *pos) noexcept {
+		tree upper;
+		if (!pos) {
+			return upper;
+		}
+		node *before = prev<H>(pos);
+		upper.first = pos;
+		upper.last = t.last;
+		while (links<H>(pos).parent) {
+			rotateUp<H>(t, pos);
+		}
+		hook &hp = links<H>(pos);
+		t.root = hp.left;
+		if (hp.left) {
+			links<H>(hp.left).parent = nullptr;
+		}
+		t.first = before ? t.first : nullptr;
+		t.last = before;
+		hp.left = nullptr;
+		upper.root = pos;
+		while (hp.right && pos->priority < hp.right->priority) {
+			rotateUp<H>(upper, hp.right);
+		}
+		return upper;
+	}
+
+	/*Przenosi do pustej kolejki result węzeł pos i wszystkie następne w porządku
+	  Cut. Drzewo Cut jest rozcinane w O(log size()). W drugim drzewie (Other)
+	  przenoszone węzły są wypinane pojedynczo, gdy jest ich mało, a w przeciwnym
+	  razie oba drzewa Other są budowane od nowa w O(size()); upper mówi, czy
+	  węzeł należy do przenoszonej części. Wszystkie porównania i przydziały
+	  pamięci odbywają się przed pierwszą zmianą. */
+	template<typename Cut, typename Other, typename Less, typename Upper>
+	void splitFrom(PriorityQueue &result, node *pos, Less less, Upper upper) {
+		std::size_t moved = 0;
+		for (node *x = pos; x; x = next<Cut>(x)) {
+			moved++;
+		}
+		node_vector movedOther;
+		node_vector keptOther;
+		bool rebuild = moved * (log2(size()) + 1) >= size();
+		movedOther.reserve(moved);
+		result.keyIndex.reserve(moved);
+		if (rebuild) {
+			keptOther.reserve(size() - moved);
+			for (node *x = treeOf(Other()).first; x; x = next<Other>(x)) {
+				(upper(x) ? movedOther : keptOther).push_back(x);
+			}
+		}
+		else {
+			for (node *x = pos; x; x = next<Cut>(x)) {
+				movedOther.push_back(x);
+			}
+			std::sort(movedOther.begin(), movedOther.end(), less);
+		}
+		result.treeOf(Cut()) = cutFrom<Cut>(treeOf(Cut()), pos);
+		if (rebuild) {
+			build<Other>(treeOf(Other()), keptOther.data(), keptOther.size());
+		}
+		for (node *x : movedOther) {
+			if (!rebuild) {
+				unlink<Other>(treeOf(Other()), x);
+			}
+			keyIndex.remove(x);
+			result.keyIndex.add(x);
+			result.digest += pairDigest(x);
+		}
+		build<Other>(result.treeOf(Other()), movedOther.data(), movedOther.size());
+		result.elements = moved;
+		result.seed = seed;
+		elements -= moved;
+		digest -= result.digest;
+	}
+
+	void clear() noexcept {
+		if (frozen) {
+			containerKV = tree();
+			containerVK = tree();
+			elements = 0;
+			digest = 0;
+			frozen.reset();
+			return;
+		}
+		destroy(containerKV.root);
+		containerKV = tree();
+		containerVK = tree();
+		keyIndex.clear();
+		elements = 0;
+		digest = 0;
+	}
+
+	/*Tworzy węzły dla par z zakresu i buduje z nich od dołu oba drzewa pustej
+	  kolejki; każdy porządek jest sortowany tylko wtedy, gdy zakres nie jest
+	  już w nim posortowany */
+	template<typename InputIt, typename Policy = PriorityQueueSequential>
+	void buildFrom(InputIt first, InputIt last, const Policy &policy = Policy()) {
+		node_vector orderKV;
+		node_vector orderVK;
+		try {
+			for (; first != last; ++first) {
+				orderKV.push_back(nullptr);
+				orderKV.back() = createNode(nextPriority(), (*first).first, (*first).second);
+			}
+			orderVK = orderKV;
+			buildOrders(orderKV, orderVK, policy);
+		}
+		catch (...) {
+			destroyNodes(orderKV);
+			throw;
+		}
+	}
+
+	void destroyNodes(const node_vector &nodes) noexcept {
+		for (node *x : nodes) {
+			if (x) {
+				destroyNode(x);
+			}
+		}
+	}
+
+	/*Sortuje oba porządki pustej kolejki, jeśli nie są już posortowane, i buduje
+	  z nich drzewa; gdy zgłosi wyjątek, kolejka jest nietknięta, a węzły
+	  z orderKV zwalnia wywołujący. Porządki są sortowane i drzewa budowane
+	  przez politykę policy, każdy porządek jako osobne zadanie. */
+	template<typename Policy = PriorityQueueSequential>
+	void buildOrders(node_vector &orderKV, node_vector &orderVK, const Policy &policy = Policy()) {
+		policy.invoke([&]() {
+			if (!std::is_sorted(orderKV.begin(), orderKV.end(), nodeLessKV)) {
+				policy.sort(orderKV.begin(), orderKV.end(), nodeLessKV);
+			}
+		}, [&]() {
+			if (!std::is_sorted(orderVK.begin(), orderVK.end(), nodeLessVK)) {
+				policy.sort(orderVK.begin(), orderVK.end(), nodeLessVK);
+			}
+		});
+		keyIndex.reserve(orderKV.size());
+		policy.invoke([&]() {
+			build<key_hook>(containerKV, orderKV.data(), orderKV.size());
+			for (node *x : orderKV) {
+				keyIndex.add(x);
+				digest += pairDigest(x);
+			}
+		}, [&]() {
+			build<value_hook>(containerVK, orderVK.data(), orderVK.size());
+		});
+		elements = orderKV.size();
+	}
+
+	using file_record = PriorityQueueFileRecord<K, V>;
+	using record_storage = typename std::aligned_storage<sizeof(file_record), alignof(file_record)>::type;
+
+	struct file_closer {
+		void operator()(std::FILE *file) const noexcept {
+			std::fclose(file);
+		}
+	};
+
+	using file_handle = std::unique_ptr<std::FILE, file_closer>;
+
+	static void readExactly(std::FILE *file, void *buffer, std::size_t bytes) {
+		if (std::fread(buffer, 1, bytes, file) != bytes) {
+			throw PriorityQueueFileException();
+		}
+	}
+
+	static void writeExactly(std::FILE *file, const void *buffer, std::size_t bytes) {
+		if (std::fwrite(buffer, 1, bytes, file) != bytes) {
+			throw PriorityQueueFileException();
+		}
+	}
+
+	/*Zapisuje kolejkę do otwartego pliku w formacie PriorityQueueFileHeader */
+	void saveTo(std::FILE *file) const {
+		std::unordered_map<const node *, std::uint64_t> ranks(size());
+		PriorityQueueFileHeader header = PriorityQueueFileHeader::describe<K, V, file_record>(size());
+		char padding[64] = {};
+		writeExactly(file, &header, sizeof(header));
+		writeExactly(file, padding, header.recordsOffset - sizeof(header));
+		std::uint64_t rank = 0;
+		for (node *x = containerKV.first; x; x = next<key_hook>(x)) {
+			// wypełnienie między polami też trafia do pliku, więc jest zerowane
+			record_storage raw;
+			std::memset(&raw, 0, sizeof(raw));
+			new (&raw) file_record{x->key, x->value};
+			writeExactly(file, &raw, sizeof(raw));
+			ranks.emplace(x, rank++);
+		}
+		writeExactly(file, padding, header.orderOffset - header.recordsOffset - size() * sizeof(file_record));
+		for (node *x = containerVK.first; x; x = next<value_hook>(x)) {
+			writeExactly(file, &ranks.find(x)->second, sizeof(std::uint64_t));
+		}
+	}
+
+	/*Wczytuje do pustej kolejki plik zapisany przez saveTo; oba porządki są
+	  odtwarzane z pliku, więc drzewa są budowane w O(n) */
+	void loadFrom(std::FILE *file) {
+		PriorityQueueFileHeader header;
+		readExactly(file, &header, sizeof(header));
+		if (std::fseek(file, 0, SEEK_END) != 0) {
+			throw PriorityQueueFileException();
+		}
+		long fileSize = std::ftell(file);
+		if (fileSize < static_cast<long>(header.recordsOffset)
+		    || !header.matches<K, V, file_record>(static_cast<std::uint64_t>(fileSize))
+		    || std::fseek(file, static_cast<long>(header.recordsOffset), SEEK_SET) != 0) {
+			throw PriorityQueueFileException();
+		}
+		std::size_t count = static_cast<std::size_t>(header.count);
+		node_vector orderKV;
+		node_vector orderVK;
+		try {
+			orderKV.reserve(count);
+			for (std::size_t i = 0; i < count; i++) {
+				record_storage raw;
+				readExactly(file, &raw, sizeof(raw));
+				const file_record &record = *reinterpret_cast<const file_record *>(&raw);
+				orderKV.push_back(createNode(nextPriority(), record.first, record.second));
+			}
+			if (std::fseek(file, static_cast<long>(header.orderOffset), SEEK_SET) != 0) {
+				throw PriorityQueueFileException();
+			}
+			std::vector<bool> seen(count, false);
+			orderVK.reserve(count);
+			for (std::size_t i = 0; i < count; i++) {
+				std::uint64_t rank;
+				readExactly(file, &rank, sizeof(rank));
+				if (rank >= count || seen[rank]) {
+					throw PriorityQueueFileException();
+				}
+				seen[rank] = true;
+				orderVK.push_back(orderKV[rank]);
+			}
+			// plik zachowuje porządek wartości, więc także kolejność wstawienia
+			if (stable) {
+				for (node *x : orderVK) {
+					stamp(x, ++seed);
+				}
+			}
+			buildOrders(orderKV, orderVK);
+		}
+		catch (...) {
+			destroyNodes(orderKV);
+			throw;
+		}
+	}
+
+	/*Odzyskuje węzły współdzielone z migawką, jeśli nikt poza kolejką już jej
+	  nie używa; zwraca false, gdy migawka nadal istnieje. Bariera acquire
+	  synchronizuje z ostatnim zwolnieniem migawki w innym wątku. */
+	bool reclaim() noexcept {
+		if (!frozen) {
+			return true;
+		}
+		if (frozen.use_count() != 1) {
+			return false;
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		keyIndex.swap(frozen->keyIndex);
+		frozen->containerKV = tree();
+		frozen->containerVK = tree();
+		frozen->elements = 0;
+		frozen.reset();
+		return true;
+	}
+
+	/*Wywoływane przed każdą modyfikacją: gdy migawka nadal istnieje, kolejka
+	  dostaje własną kopię par, a migawka zostaje nietknięta. Kopiowanie
+	  unieważnia uchwyty do par kolejki, bo wskazują na węzły migawki; węzeł
+	  *tracked, jeśli podany, jest zastępowany kopią swojej pary.
+	  Złożoność: O(1), a O(size()) przy kopiowaniu
+	  Exception safety: strong */
+	void detach(node **tracked = nullptr) {
+		if (reclaim()) {
+			return;
+		}
+		tree sharedKV = containerKV;
+		tree sharedVK = containerVK;
+		containerKV = tree();
+		containerVK = tree();
+		elements = 0;
+		try {
+			copyFrom(*frozen, tracked);
+		}
+		catch (...) {
+			containerKV = sharedKV;
+			containerVK = sharedVK;
+			elements = frozen->elements;
+			throw;
+		}
+		frozen.reset();
+	}
+
+	/*Para zdejmowana z węzła jest budowana przez przeniesienie obu pól tylko
+	  wtedy, gdy oba da się przenieść bez wyjątków; w przeciwnym razie oba są
+	  kopiowane, bo wyjątek przy kopiowaniu wartości zostawiłby w węźle
+	  przeniesiony już klucz */
+	static const bool pair_movable = std::is_nothrow_move_constructible<K>::value
+		&& std::is_nothrow_move_assignable<K>::value && std::is_nothrow_move_constructible<V>::value
+		&& std::is_nothrow_move_assignable<V>::value;
+
+	template<typename T>
+	using pair_field = typename std::conditional<pair_movable, T &&, const T &>::type;
+
+	/*Wspólna implementacja popMin i popMax. Węzły są zdejmowane z krańca drzewa
+	  wartości, co kosztuje O(1) zamortyzowane. Z drzewa kluczy są wypinane
+	  pojedynczo, a gdy zdejmowanych par jest dużo, drzewo kluczy jest budowane
+	  od nowa z pozostałych węzłów w O(size()). */
+	template<typename OutputIt>
+	OutputIt popExtreme(std::size_t n, OutputIt out, bool fromMin) {
+		stats_mark started = statistics.start();
+		PriorityQueueEvent event = fromMin ? PriorityQueueEvent::deleteMin : PriorityQueueEvent::deleteMax;
+		detach();
+		std::size_t count = n < size() ? n : size();
+		std::size_t requested = count;
+		node_vector kept;
+		bool rebuild = count * (log2(size()) + 1) >= size();
+		if (rebuild) {
+			try {
+				kept.reserve(size());
+			}
+			catch (...) {
+				rebuild = false;
+			}
+		}
+		node *popped = nullptr;
+		try {
+			for (; count > 0; count--) {
+				node *x = fromMin ? containerVK.first : containerVK.last;
+				std::uint64_t term = pairDigest(x);
+				// indeks haszuje klucz, więc węzeł jest z niego usuwany przed przeniesieniem klucza
+				keyIndex.remove(x);
+				try {
+					std::pair<K, V> extreme(static_cast<pair_field<K>>(x->key), static_cast<pair_field<V>>(x->value));
+					try {
+						*out = std::move(extreme);
+						++out;
+					}
+					catch (...) {
+						if (pair_movable) {
+							x->key = std::move(extreme.first);
+							x->value = std::move(extreme.second);
+						}
+						throw;
+					}
+				}
+				catch (...) {
+					keyIndex.add(x);
+					throw;
+				}
+				unlink<value_hook>(containerVK, x);
+				digest -= term;
+				elements--;
+				if (rebuild) {
+					x->byValue.parent = x;
+					x->byValue.right = popped;
+					popped = x;
+				}
+				else {
+					unlink<key_hook>(containerKV, x);
+					destroyNode(x);
+				}
+			}
+		}
+		catch (...) {
+			if (rebuild) {
+				dropPopped(kept, popped);
+			}
+			record(event, requested - count, started);
+			throw;
+		}
+		if (rebuild) {
+			dropPopped(kept, popped);
+		}
+		record(event, requested, started);
+		return out;
+	}
+
+	/*Buduje drzewo kluczy z węzłów nieoznaczonych jako zdjęte i zwalnia
+	  zdjęte węzły połączone w listę przez byValue.right */
+	void dropPopped(node_vector &kept, node *popped) noexcept {
+		for (node *x = containerKV.first; x; x = next<key_hook>(x)) {
+			if (x->byValue.parent != x) {
+				kept.push_back(x);
+			}
+		}
+		build<key_hook>(containerKV, kept.data(), kept.size());
+		while (popped) {
+			node *following = popped->byValue.right;
+			destroyNode(popped);
+			popped = following;
+		}
+	}
+
+	/*Wspólna implementacja tryPopMin i tryPopMax */
+	PriorityQueueOptional<std::pair<K, V>> popOne(bool fromMin) {
+		PriorityQueueOptional<std::pair<K, V>> result;
+		if (empty()) {
+			return result;
+		}
+		stats_mark started = statistics.start();
+		detach();
+		node *x = fromMin ? containerVK.first : containerVK.last;
+		std::uint64_t term = pairDigest(x);
+		keyIndex.remove(x);
+		try {
+			result.emplace(static_cast<pair_field<K>>(x->key), static_cast<pair_field<V>>(x->value));
+		}
+		catch (...) {
+			keyIndex.add(x);
+			throw;
+		}
+		unlink<key_hook>(containerKV, x);
+		unlink<value_hook>(containerVK, x);
+		digest -= term;
+		elements--;
+		destroyNode(x);
+		record(fromMin ? PriorityQueueEvent::deleteMin : PriorityQueueEvent::deleteMax, 1, started);
+		return result;
+	}
+
+	template<typename... Args>
+	node *emplaceNode(Args &&... args) {
+		stats_mark started = statistics.start();
+		detach();
+		keyIndex.reserve(size() + 1);
+		node *x = createNode(nextPriority(), std::forward<Args>(args)...);
+		node *posKV, *posVK;
+		try {
+			posKV = upperKV(x->key, x->value);
+			posVK = upperVK(x->value, x->key);
+		}
+		catch (...) {
+			destroyNode(x);
+			throw;
+		}
+		linkNode(x, posKV, posVK);
+		record(PriorityQueueEvent::insert, 1, started);
+		return x;
+	}
+
+	/*Zwraca false, nic nie zmieniając, gdy klucza nie ma w kolejce */
+	template<typename VArg>
+	bool changeKeyValue(const K &key, VArg &&value) {
+		stats_mark started = statistics.start();
+		node *old = findKey(key);
+		if (!old) {
+			record(PriorityQueueEvent::changeMiss, 1, started);
+			return false;
+		}
+		if (frozen) {
+			detach();
+			old = findKey(key);
+		}
+		replaceValue(old, std::forward<VArg>(value), std::is_nothrow_move_assignable<V>());
+		record(PriorityQueueEvent::changeHit, 1, started);
+		return true;
+	}
+
+	/*Zmienia wartość węzła old bez przydzielania pamięci: nowa wartość jest
+	  tworzona obok, a przeniesienie jej do węzła nie zgłasza wyjątków */
+	template<typename VArg>
+	void replaceValue(node *old, VArg &&value, std::true_type) {
+		V replacement(std::forward<VArg>(value));
+		reposition(old, replacement);
+	}
+
+	/*Bez przenoszenia noexcept nowa para trafia do nowego węzła, który zastępuje
+	  stary dopiero wtedy, gdy nic już nie może zgłosić wyjątku */
+	template<typename VArg>
+	void replaceValue(node *old, VArg &&value, std::false_type) {
+		const K &key = old->key;
+		keyIndex.reserve(size() + 1);
+		node *x = createNode(nextPriority(), key, std::forward<VArg>(value));
+		node *posKV, *posVK;
+		try {
+			// jedyny węzeł o tym kluczu zostaje na swoim miejscu w drzewie kluczy
+			posKV = next<key_hook>(old);
+			if (posKV && !(key < posKV->key)) {
+				posKV = upperKV(x->key, x->value);
+			}
+			posVK = upperVK(x->value, x->key);
+		}
+		catch (...) {
+			destroyNode(x);
+			throw;
+		}
+		if (posKV == old) {
+			posKV = next<key_hook>(old);
+		}
+		if (posVK == old) {
+			posVK = next<value_hook>(old);
+		}
+		unlinkNode(old);
+		destroyNode(old);
+		linkNode(x, posKV, posVK);
+	}
+
+	/*Nowe wartości dla changeAllValues: kopie są tworzone w konstruktorze, gdy
+	  przypisanie kopiujące V może zgłosić wyjątek, a przypisywane są bez wyjątków */
+	class replacement_values {
+	public:
+		replacement_values(std::size_t n, const V &v) : value(v) {
+			if (!std::is_nothrow_copy_assignable<V>::value) {
+				copies.assign(n, v);
+			}
+		}
+
+		void assign(V &target, std::size_t i) noexcept {
+			assign(target, i, std::is_nothrow_copy_assignable<V>());
+		}
+
+	private:
+		const V &value;
+		std::vector<V> copies;
+
+		void assign(V &target, std::size_t, std::true_type) noexcept {
+			target = value;
+		}
+
+		void assign(V &target, std::size_t i, std::false_type) noexcept {
+			target = std::move(copies[i]);
+		}
+	};
+
+	/*Wspólna implementacja insert: gdy kolejka jest pełna, para nie mniejsza
+	  (w porządku wartości) od największej jest odrzucana przed przydzieleniem
+	  pamięci i wynikiem jest nullptr */
+	template<typename KArg, typename VArg>
+	node *insertNode(KArg &&key, VArg &&value) {
+		if (elements < limit) {
+			return emplaceNode(std::forward<KArg>(key), std::forward<VArg>(value));
+		}
+		if (limit == 0 || !precedesVK(value, key, containerVK.last)) {
+			return nullptr;
+		}
+		return replaceMax(std::forward<KArg>(key), std::forward<VArg>(value), std::integral_constant<bool, recyclable>());
+	}
+
+	/*Wypiera parę o największej wartości, przenosząc nową parę do jej węzła;
+	  kopie i porównania wykonują się przed jakąkolwiek zmianą */
+	template<typename KArg, typename VArg>
+	node *replaceMax(KArg &&key, VArg &&value, std::true_type) {
+		stats_mark started = statistics.start();
+		detach();
+		K replacementKey(std::forward<KArg>(key));
+		V replacementValue(std::forward<VArg>(value));
+		node *x = containerVK.last;
+		node *posKV = upperKV(replacementKey, replacementValue);
+		node *posVK = upperVK(replacementValue, replacementKey);
+		if (posKV == x) {
+			posKV = next<key_hook>(x);
+		}
+		if (posVK == x) {
+			posVK = next<value_hook>(x);
+		}
+		unlinkNode(x);
+		x->key = std::move(replacementKey);
+		x->value = std::move(replacementValue);
+		stamp(x, ++seed);
+		linkNode(x, posKV, posVK);
+		record(PriorityQueueEvent::deleteMax, 1, started);
+		record(PriorityQueueEvent::insert, 1, started);
+		return x;
+	}
+
+	template<typename KArg, typename VArg>
+	node *replaceMax(KArg &&key, VArg &&value, std::false_type) {
+		return bounded(emplaceNode(std::forward<KArg>(key), std::forward<VArg>(value)));
+	}
+
+	/*Usuwa parę o największej wartości, gdy kolejka przekroczyła limit
+	  o jedną parę; zwraca x albo nullptr, gdy usunięta została właśnie para x */
+	node *bounded(node *x) noexcept {
+		if (elements <= limit) {
+			return x;
+		}
+		stats_mark started = statistics.start();
+		node *evicted = containerVK.last;
+		unlinkNode(evicted);
+		destroyNode(evicted);
+		record(PriorityQueueEvent::deleteMax, 1, started);
+		return evicted == x ? nullptr : x;
+	}
+
+	/*Usuwa pary o największych wartościach ponad limit; wymaga wcześniejszego detach() */
+	void trim(stats_mark started) noexcept {
+		size_type removed = 0;
+		for (; elements > limit; removed++) {
+			node *evicted = containerVK.last;
+			unlinkNode(evicted);
+			destroyNode(evicted);
+		}
+		if (removed) {
+			record(PriorityQueueEvent::deleteMax, removed, started);
+		}
+	}
+
+public:
+	using size_type = std::size_t;
+	using key_type = K;
+	using value_type = V;
+	using snapshot_type = std::shared_ptr<const PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak>>;
+	using allocator_type = Alloc;
+
+	/*Liczba bajtów zajmowanych przez jedną parę, bez narzutu alokatora */
+	static constexpr size_type node_size = sizeof(node);
+
+	/*Uchwyt do pary przechowywanej w kolejce. Pozostaje ważny, dopóki para nie
+	  zostanie usunięta z kolejki (także po changeValue(handle, value) oraz po
+	  merge z kolejką o równym alokatorze, w której para dalej się znajduje),
+	  albo do modyfikacji kolejki kopiującej pary współdzielone z migawką
+	  (patrz snapshot()). */
+	class handle {
+	public:
+		handle() noexcept
+			: target(nullptr) {
+		}
+
+		const K &key() const {
+			return target->key;
+		}
+
+		const V &value() const {
+			return target->value;
+		}
+
+		bool operator==(const handle &other) const noexcept {
+			return target == other.target;
+		}
+
+		bool operator!=(const handle &other) const noexcept {
+			return target != other.target;
+		}
+
+	private:
+		friend class PriorityQueue;
+
+		explicit handle(node *x) noexcept
+			: target(x) {
+		}
+
+		node *target;
+	};
+
+	/*Dwukierunkowy iterator po parach w porządku jednego z drzew; nie kopiuje
+	  par, a *it zwraca parę referencji. Iteratory tracą ważność przy modyfikacji
+	  kolejki. */
+	template<typename H>
+	class order_iterator {
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = std::pair<K, V>;
+		using difference_type = std::ptrdiff_t;
+		using reference = std::pair<const K &, const V &>;
+
+		/*Wynik operatora ->, przechowujący parę referencji */
+		class pointer {
+		public:
+			const reference *operator->() const noexcept {
+				return &pair;
+			}
+
+		private:
+			friend class order_iterator;
+
+			explicit pointer(const reference &p) noexcept : pair(p) {
+			}
+
+			reference pair;
+		};
+
+		order_iterator() noexcept
+			: target(nullptr), owner(nullptr) {
+		}
+
+		const K &key() const noexcept {
+			return target->key;
+		}
+
+		const V &value() const noexcept {
+			return target->value;
+		}
+
+		reference operator*() const noexcept {
+			return reference(target->key, target->value);
+		}
+
+		pointer operator->() const noexcept {
+			return pointer(**this);
+		}
+
+		/*Uchwyt do wskazywanej pary, np. do changeValue albo erase */
+		handle toHandle() const noexcept {
+			return handle(target);
+		}
 
-	template<typename T>
-	struct cmp {
-		bool operator()(const T &a, const T &b) {
-			if (*a.first < *b.first) {
-				return true;
-			}
-			if (*b.first < *a.first) {
-				return false;
-			}
-			return *a.second < *b.second;
+		order_iterator &operator++() noexcept {
+			target = next<H>(target);
+			return *this;
+		}
+
+		order_iterator operator++(int) noexcept {
+			order_iterator previous = *this;
+			++*this;
+			return previous;
+		}
+
+		order_iterator &operator--() noexcept {
+			target = target ? prev<H>(target) : owner->last;
+			return *this;
+		}
+
+		order_iterator operator--(int) noexcept {
+			order_iterator previous = *this;
+			--*this;
+			return previous;
+		}
+
+		bool operator==(const order_iterator &other) const noexcept {
+			return target == other.target;
+		}
+
+		bool operator!=(const order_iterator &other) const noexcept {
+			return target != other.target;
+		}
+
+	private:
+		friend class PriorityQueue;
+
+		order_iterator(node *x, const tree *t) noexcept
+			: target(x), owner(t) {
 		}
+
+		node *target;
+		const tree *owner;
 	};
 
-	std::multiset <key_value, cmp<key_value>> containerKV;
-	std::multiset <value_key, cmp<value_key>> containerVK;
-public:
-	using size_type = std::size_t;
-	using key_type = K;
-	using value_type = V;
+	/*Widok na fragment jednego z porządków, np. wynik valueRange; nadaje się do
+	  pętli for po zakresie */
+	template<typename H>
+	class order_range {
+	public:
+		using iterator = order_iterator<H>;
+
+		iterator begin() const noexcept {
+			return first;
+		}
+
+		iterator end() const noexcept {
+			return last;
+		}
+
+		bool empty() const noexcept {
+			return first == last;
+		}
+
+	private:
+		friend class PriorityQueue;
+
+		order_range(iterator from, iterator to) noexcept
+			: first(from), last(to) {
+		}
+
+		iterator first;
+		iterator last;
+	};
+
+	using const_value_iterator = order_iterator<value_hook>;
+	using const_key_iterator = order_iterator<key_hook>;
+	using const_reverse_value_iterator = std::reverse_iterator<const_value_iterator>;
+	using const_reverse_key_iterator = std::reverse_iterator<const_key_iterator>;
+	using value_range = order_range<value_hook>;
+	using key_range = order_range<key_hook>;
 
 	/*Konstruktor bezparametrowy tworzący pustą kolejkę
 	  Złożoność: O(1)
 	  Exception safety: no-throw */
 	PriorityQueue() = default;
 
+	/*Konstruktor tworzący pustą kolejkę, która przydziela pamięć przez allocator
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	explicit PriorityQueue(const Alloc &allocator)
+		: alloc(allocator) {
+	}
+
+	/*Konstruktor tworzący kolejkę z par (klucz, wartość) z zakresu [first, last)
+	  Złożoność: O(n) dla zakresu posortowanego po kluczach i po wartościach,
+	  O(n log n) w przeciwnym razie
+	  Exception safety: strong */
+	template<typename InputIt, typename = pair_iterator<InputIt>>
+	PriorityQueue(InputIt first, InputIt last, const Alloc &allocator = Alloc())
+		: alloc(allocator) {
+		buildFrom(first, last);
+	}
+
+	/*Konstruktor tworzący kolejkę z par z zakresu [first, last) jak wyżej;
+	  oba porządki są sortowane i oba drzewa budowane zgodnie z polityką
+	  wykonania policy (np. PriorityQueueParallel), a węzły są tworzone
+	  w wywołującym wątku. Przy polityce równoległej operatory < dla K i V
+	  są wywoływane z wielu wątków naraz dla tych samych obiektów.
+	  Złożoność: jak wyżej
+	  Exception safety: strong */
+	template<typename Policy, typename InputIt, typename = execution_policy<Policy>, typename = pair_iterator<InputIt>>
+	PriorityQueue(const Policy &policy, InputIt first, InputIt last, const Alloc &allocator = Alloc())
+		: alloc(allocator) {
+		buildFrom(first, last, policy);
+	}
+
 	/*Desktruktor
 	  Exception safety: no-throw */
 	~PriorityQueue() {
-		containerKV.clear();
-		containerVK.clear();
+		clear();
 	}
 
 	/*Konstruktor kopiujący
 	  Złożoność: O(queue.size())
-	  Exception safety: no-throw */
-	PriorityQueue(const PriorityQueue<K, V> &queue)
-		: containerKV(queue.containerKV),
-		  containerVK(queue.containerVK) {
+	  Exception safety: strong */
+	PriorityQueue(const PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &queue)
+		: alloc(node_traits::select_on_container_copy_construction(queue.alloc)), limit(queue.limit) {
+		copyFrom(queue);
+	}
+
+	/*Konstruktor kopiujący z podanym alokatorem
+	  Złożoność: O(queue.size())
+	  Exception safety: strong */
+	PriorityQueue(const PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &queue, const Alloc &allocator)
+		: alloc(allocator), limit(queue.limit) {
+		copyFrom(queue);
 	}
 
 	/*Konstruktor przenoszący
 	  Złożoność: O(1)
 	  Exception safety: no-throw */
-	PriorityQueue(PriorityQueue<K, V> &&queue)
-		: containerKV(std::move(queue.containerKV)),
-		  containerVK(std::move(queue.containerVK)) {
+	PriorityQueue(PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &&queue) noexcept
+		: alloc(std::move(queue.alloc)),
+		  containerKV(queue.containerKV),
+		  containerVK(queue.containerVK),
+		  elements(queue.elements),
+		  limit(queue.limit),
+		  seed(queue.seed),
+		  digest(queue.digest),
+		  keyIndex(alloc),
+		  frozen(std::move(queue.frozen)) {
+		keyIndex.swap(queue.keyIndex);
+		queue.containerKV = tree();
+		queue.containerVK = tree();
+		queue.elements = 0;
+		queue.digest = 0;
 	}
 
 	/*Operator przypisania dla użycia P = Q
 	  Złożoność: O(queue.size())
 	  Exception safety: strong */
-	PriorityQueue<K, V> &operator=(const PriorityQueue<K, V> &queue) {
+	PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &operator=(const PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &queue) {
 		if (&queue == this) {
 			return *this;
 		}
-		decltype(containerKV) copyKV(containerKV);
-		decltype(containerVK) copyVK(containerVK);
-		copyKV = queue.containerKV;
-		copyVK = queue.containerVK;
-		containerKV.swap(copyKV);
-		containerVK.swap(copyVK);
+		stats_mark started = statistics.start();
+		PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> copy(queue,
+			node_traits::propagate_on_container_copy_assignment::value ? queue.alloc : alloc);
+		swapAll(copy);
+		record(PriorityQueueEvent::allocate, size(), started);
 		return *this;
 	}
 
 	/*Operator przypisania dla użycia P = move(Q)
+	  Złożoność: O(1), a O(queue.size()) gdy alokatory są różne i nie są propagowane
+	  Exception safety: no-throw, a strong gdy alokatory są różne i nie są propagowane */
+	PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &operator=(PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &&queue)
+		noexcept(node_traits::propagate_on_container_move_assignment::value) {
+		if (&queue == this) {
+			return *this;
+		}
+		if (!node_traits::propagate_on_container_move_assignment::value && !(alloc == queue.alloc)) {
+			stats_mark started = statistics.start();
+			PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> copy(queue, alloc);
+			swapAll(copy);
+			record(PriorityQueueEvent::allocate, size(), started);
+			return *this;
+		}
+		PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> moved(std::move(queue));
+		swapAll(moved);
+		return *this;
+	}
+
+	/*Metoda zwracająca alokator używany przez kolejkę
 	  Złożoność: O(1)
 	  Exception safety: no-throw */
-	PriorityQueue<K, V> &operator=(PriorityQueue<K, V> &&queue) {
-		containerKV = std::move(queue.containerKV);
-		containerVK = std::move(queue.containerVK);
-		return *this;
+	allocator_type get_allocator() const {
+		return allocator_type(alloc);
 	}
 
 	/*Metoda zwracająca true wtedy i tylko wtedy, gdy kolejka jest pusta
 	  Złożoność: O(1)
 	  Exception safety: no-throw */
 	bool empty() const {
-		return containerKV.empty();
+		return elements == 0;
 	}
 
 	/*Metoda zwracająca liczbę par (klucz, wartość) przechowywanych w kolejce
 	  Złożoność: O(1)
 	  Exception safety: no-throw */
 	size_type size() const {
-		return containerKV.size();
+		return elements;
+	}
+
+	/*Metoda ograniczająca kolejkę do capacity par o najmniejszych wartościach:
+	  nadmiarowe pary o największych wartościach są usuwane od razu, a insert
+	  w pełnej kolejce odrzuca parę nie mniejszą od największej, zanim
+	  przydzieli pamięć, albo wypiera parę o największej wartości, przenosząc
+	  nową parę do jej węzła (gdy przypisania przenoszące K i V nie zgłaszają
+	  wyjątków). Wstawianie zakresu, assign i merge usuwają nadmiar na końcu.
+	  Limit jest kopiowany razem z kolejką.
+	  Złożoność: O((1 + liczba usuniętych par) log size())
+	  Exception safety: strong */
+	void setCapacity(size_type capacity) {
+		stats_mark started = statistics.start();
+		if (elements > capacity) {
+			detach();
+		}
+		limit = capacity;
+		trim(started);
+	}
+
+	/*Metoda zwracająca limit liczby par ustawiony przez setCapacity, domyślnie
+	  std::numeric_limits<size_type>::max()
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	size_type capacity() const noexcept {
+		return limit;
+	}
+
+	/*Metoda zwracająca statystyki zebrane przez politykę Stats oraz obecny
+	  i największy rozmiar i pamięć zajmowaną przez węzły (bez narzutu
+	  alokatora); z PriorityQueueNoStats liczniki i wartości szczytowe są zerami
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	PriorityQueueStats stats() const noexcept {
+		PriorityQueueStats result;
+		statistics.collect(result);
+		result.size = size();
+		result.bytes = size() * node_size;
+		result.peakBytes = result.peakSize * node_size;
+		return result;
+	}
+
+	/*Metody zwracające obiekt polityki statystyk, np. żeby podpiąć do niego
+	  eksport metryk
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	Stats &statsPolicy() noexcept {
+		return statistics;
+	}
+
+	const Stats &statsPolicy() const noexcept {
+		return statistics;
 	}
 
-	/*Metoda wstawiająca do kolejki parę o kluczu key i wartości value
+	/*Metoda wstawiająca do kolejki parę o kluczu key i wartości value;
+	  zwraca uchwyt do wstawionej pary, a pusty uchwyt, gdy pełna kolejka
+	  (patrz setCapacity) odrzuciła parę
 	  Złożoność: O(log size())
 	  Exception safety: strong */
-	void insert(const K &key, const V &value) {
-		K new_key = key;
-		V new_value = value;
-		key_shared k_shared = std::make_shared<K>(new_key);
-		value_shared v_shared = std::make_shared<V>(new_value);
-		auto it = containerKV.insert(std::make_pair(k_shared, v_shared));
-		try {
-			containerVK.insert(std::make_pair(v_shared, k_shared));
+	handle insert(const K &key, const V &value) {
+		return handle(insertNode(key, value));
+	}
+
+	/*Metoda wstawiająca do kolejki parę, przenosząc klucz i wartość do węzła
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	handle insert(K &&key, V &&value) {
+		return handle(insertNode(std::move(key), std::move(value)));
+	}
+
+	/*Metoda wstawiająca do kolejki parę, kopiując klucz i przenosząc wartość
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	handle insert(const K &key, V &&value) {
+		return handle(insertNode(key, std::move(value)));
+	}
+
+	/*Metoda tworząca parę bezpośrednio w węźle kolejki; klucz jest tworzony
+	  z argumentów keyArgs, a wartość z argumentów valueArgs. W pełnej
+	  kolejce para jest najpierw tworzona, a potem usuwana para o największej
+	  wartości; gdy jest nią nowa para, wynikiem jest pusty uchwyt.
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	template<typename... KArgs, typename... VArgs>
+	handle emplace(std::piecewise_construct_t, std::tuple<KArgs...> keyArgs, std::tuple<VArgs...> valueArgs) {
+		return handle(bounded(emplaceNode(std::piecewise_construct, std::move(keyArgs), std::move(valueArgs))));
+	}
+
+	/*Metoda wstawiająca do kolejki wszystkie pary (klucz, wartość) z zakresu [first, last)
+	  Złożoność: O(n log n + size()), gdzie n to długość zakresu
+	  Exception safety: strong */
+	template<typename InputIt, typename = pair_iterator<InputIt>>
+	void insert(InputIt first, InputIt last) {
+		stats_mark started = statistics.start();
+		PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> added(first, last, Alloc(alloc));
+		size_type n = added.size();
+		detach();
+		spliceAll(added);
+		record(PriorityQueueEvent::allocate, n, started);
+		record(PriorityQueueEvent::insert, n, started);
+		trim(started);
+	}
+
+	/*Metoda zastępująca zawartość kolejki parami (klucz, wartość) z zakresu [first, last)
+	  Złożoność: O(n) dla zakresu posortowanego, O(n log n) w przeciwnym razie
+	  Exception safety: strong */
+	template<typename InputIt, typename = pair_iterator<InputIt>>
+	void assign(InputIt first, InputIt last) {
+		stats_mark started = statistics.start();
+		PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> assigned(first, last, Alloc(alloc));
+		assigned.limit = limit;
+		clear();
+		swapAll(assigned);
+		record(PriorityQueueEvent::allocate, size(), started);
+		record(PriorityQueueEvent::insert, size(), started);
+		trim(started);
+	}
+
+	/*Metody zwracające iteratory po parach w porządku rosnących wartości
+	  (przy równych wartościach według kluczy) i w porządku rosnących kluczy
+	  (przy równych kluczach według wartości)
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	const_value_iterator valueBegin() const noexcept {
+		return const_value_iterator(containerVK.first, &containerVK);
+	}
+
+	const_value_iterator valueEnd() const noexcept {
+		return const_value_iterator(nullptr, &containerVK);
+	}
+
+	const_reverse_value_iterator valueRBegin() const noexcept {
+		return const_reverse_value_iterator(valueEnd());
+	}
+
+	const_reverse_value_iterator valueREnd() const noexcept {
+		return const_reverse_value_iterator(valueBegin());
+	}
+
+	const_key_iterator keyBegin() const noexcept {
+		return const_key_iterator(containerKV.first, &containerKV);
+	}
+
+	const_key_iterator keyEnd() const noexcept {
+		return const_key_iterator(nullptr, &containerKV);
+	}
+
+	const_reverse_key_iterator keyRBegin() const noexcept {
+		return const_reverse_key_iterator(keyEnd());
+	}
+
+	const_reverse_key_iterator keyREnd() const noexcept {
+		return const_reverse_key_iterator(keyBegin());
+	}
+
+	/*Metody zwracające widok na pary o wartościach z przedziału [lo, hi)
+	  albo o kluczach z przedziału [lo, hi); dla hi <= lo widok jest pusty
+	  Złożoność: O(log size()), a przejście po widoku O(długość widoku)
+	  Exception safety: strong */
+	value_range valueRange(const V &lo, const V &hi) const {
+		node *from = lowerValue(lo);
+		node *to = lo < hi ? lowerValue(hi) : from;
+		return value_range(const_value_iterator(from, &containerVK), const_value_iterator(to, &containerVK));
+	}
+
+	key_range keyRange(const K &lo, const K &hi) const {
+		node *from = lowerKey(lo);
+		node *to = lo < hi ? lowerKey(hi) : from;
+		return key_range(const_key_iterator(from, &containerKV), const_key_iterator(to, &containerKV));
+	}
+
+	/*Metody zwracające widok na wszystkie pary w porządku wartości albo kluczy
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	value_range byValue() const noexcept {
+		return value_range(valueBegin(), valueEnd());
+	}
+
+	key_range byKey() const noexcept {
+		return key_range(keyBegin(), keyEnd());
+	}
+
+	/*Metoda zapisująca do out, dla kolejnych par w porządku wartości, pozycję
+	  tej pary w porządku kluczy (licząc od 0), np. do odtworzenia obu porządków
+	  w kopii trzymanej w tablicach; pozycje są zapamiętywane przy jednym
+	  przejściu po porządku kluczy, jak przy kopiowaniu kolejki
+	  Złożoność: O(size()) średnio
+	  Exception safety: strong (nie licząc elementów już zapisanych do out) */
+	template<typename OutputIt>
+	OutputIt keyPositionsByValue(OutputIt out) const {
+		std::unordered_map<const node *, size_type> positions(size());
+		size_type position = 0;
+		for (node *x = containerKV.first; x; x = next<key_hook>(x)) {
+			positions.emplace(x, position++);
 		}
-		catch (...) {
-			containerKV.erase(it);
+		for (node *x = containerVK.first; x; x = next<value_hook>(x)) {
+			*out = positions.find(x)->second;
+			++out;
 		}
+		return out;
 	}
 
 	/*Metoda zwracająca najmniejszą wartość przechowywaną w kolejce
 	  Złożoność: O(1)
 	  Exception safety: strong */
 	const V &minValue() const {
-		if (empty()) {
-			throw PriorityQueueEmptyException();
-		}
-		return *containerVK.begin()->first;
+		return nonEmpty(containerVK.first)->value;
 	}
 
 	/*Metoda zwracająca największą wartość przechowywaną w kolejce
 	  Złożoność: O(1)
 	  Exception safety: strong */
 	const V &maxValue() const {
-		if (empty()) {
-			throw PriorityQueueEmptyException();
-		}
-		return *containerVK.rbegin()->first;
+		return nonEmpty(containerVK.last)->value;
 	}
 
 	/*Metoda zwracająca klucz o przypisanej najmniejszej wartości
 	  Złożoność: O(1)
 	  Exception safety: strong */
 	const K &minKey() const {
-		if (empty()) {
-			throw PriorityQueueEmptyException();
-		}
-		return *containerVK.begin()->second;
+		return nonEmpty(containerVK.first)->key;
 	}
 
 	/*Metoda zwracająca klucz o przypisanej największej wartości
 	  Złożoność: O(1)
 	  Exception safety: strong */
 	const K &maxKey() const {
-		if (empty()) {
-			throw PriorityQueueEmptyException();
-		}
-		return *containerVK.rbegin()->second;
+		return nonEmpty(containerVK.last)->key;
+	}
+
+	/*Metody zwracające wskaźnik do najmniejszej albo największej wartości
+	  i przypisanego jej klucza, albo nullptr dla pustej kolejki, zamiast rzucać
+	  wyjątek; wskaźnik jest ważny do modyfikacji kolejki
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	const V *tryMinValue() const noexcept {
+		return containerVK.first ? &containerVK.first->value : nullptr;
+	}
+
+	const V *tryMaxValue() const noexcept {
+		return containerVK.last ? &containerVK.last->value : nullptr;
+	}
+
+	const K *tryMinKey() const noexcept {
+		return containerVK.first ? &containerVK.first->key : nullptr;
+	}
+
+	const K *tryMaxKey() const noexcept {
+		return containerVK.last ? &containerVK.last->key : nullptr;
 	}
 
 	/*Metoda usuwająca z kolejki jedną parę o najmniejszej wartości
 	  Złożoność: O(log size())
-	  Exception safety: no-throw */
+	  Exception safety: no-throw, a strong gdy istnieje migawka kolejki */
 	void deleteMin() {
 		if (empty()) {
 			return;
 		}
-		auto it = containerVK.begin();
-		key_value pair = std::make_pair(it->second, it->first);
-		auto it2 = containerKV.find(pair);
-		containerVK.erase(it);
-		containerKV.erase(it2);
+		stats_mark started = statistics.start();
+		detach();
+		node *x = containerVK.first;
+		unlinkNode(x);
+		destroyNode(x);
+		record(PriorityQueueEvent::deleteMin, 1, started);
 	}
 
 	/*Metoda usuwająca z kolejki jedną parę o największej wartości
 	  Złożoność: O(log size())
-	  Exception safety: no-throw */
+	  Exception safety: no-throw, a strong gdy istnieje migawka kolejki */
 	void deleteMax() {
 		if (empty()) {
 			return;
 		}
-		auto it = containerVK.end();
-		it--;
-		key_value pair = std::make_pair(it->second, it->first);
-		auto it2 = containerKV.find(pair);
-		containerVK.erase(it);
-		containerKV.erase(it2);
+		stats_mark started = statistics.start();
+		detach();
+		node *x = containerVK.last;
+		unlinkNode(x);
+		destroyNode(x);
+		record(PriorityQueueEvent::deleteMax, 1, started);
+	}
+
+	/*Metody usuwające z kolejki parę o najmniejszej albo największej wartości
+	  i zwracające ją (klucz i wartość są przenoszone, jeśli da się to zrobić
+	  bez wyjątków); dla pustej kolejki zwracają pusty wynik
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	PriorityQueueOptional<std::pair<K, V>> tryPopMin() {
+		return popOne(true);
+	}
+
+	PriorityQueueOptional<std::pair<K, V>> tryPopMax() {
+		return popOne(false);
+	}
+
+	/*Metoda usuwająca z kolejki n par o najmniejszych wartościach (albo wszystkie,
+	  gdy jest ich mniej) i zapisująca je do out jako std::pair<K, V> w kolejności
+	  rosnących wartości; zwraca iterator za ostatnią zapisaną parą
+	  Złożoność: O(n log size()), a O(n + size()) gdy n jest porównywalne z size()
+	  Exception safety: basic (pary zapisane do out są usunięte z kolejki,
+	  a para, której zapis się nie powiódł, i wszystkie kolejne pozostają w kolejce) */
+	template<typename OutputIt>
+	OutputIt popMin(size_type n, OutputIt out) {
+		return popExtreme(n, out, true);
+	}
+
+	/*Metoda usuwająca z kolejki n par o największych wartościach (albo wszystkie,
+	  gdy jest ich mniej) i zapisująca je do out jako std::pair<K, V> w kolejności
+	  malejących wartości; zwraca iterator za ostatnią zapisaną parą
+	  Złożoność: O(n log size()), a O(n + size()) gdy n jest porównywalne z size()
+	  Exception safety: basic (jak w popMin) */
+	template<typename OutputIt>
+	OutputIt popMax(size_type n, OutputIt out) {
+		return popExtreme(n, out, false);
 	}
 
-	/*Metoda zmieniająca dotychczasową wartość przypisaną kluczowi key na nową wartość value
+	/*Metoda zmieniająca dotychczasową wartość przypisaną kluczowi key na nową wartość value.
+	  Gdy przypisanie przenoszące V nie zgłasza wyjątków, węzeł pary jest
+	  przepinany bez przydzielania pamięci (poza kopią value), a uchwyt do
+	  pary pozostaje ważny; w przeciwnym razie para trafia do nowego węzła.
 	  Złożoność: O(log size())
 	  Exception safety: strong */
 	void changeValue(const K &key, const V &value) {
-		if (empty()) {
+		if (!changeKeyValue(key, value)) {
 			throw PriorityQueueNotFoundException();
 		}
-		V tmp_value = minValue();
-		key_value pair = std::make_pair(std::make_shared<K>(key), std::make_shared<V>(tmp_value));
-		auto it = containerKV.lower_bound(pair);
-		if (it == containerKV.end() || *it->first < key || key < *it->first) {
+	}
+
+	/*Metoda zmieniająca wartość przypisaną kluczowi key, przenosząc value do kolejki,
+	  jak wyżej
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	void changeValue(const K &key, V &&value) {
+		if (!changeKeyValue(key, std::move(value))) {
 			throw PriorityQueueNotFoundException();
 		}
-		tmp_value = *it->second;
-		value_key pair2 = std::make_pair(std::make_shared<V>(tmp_value), std::make_shared<K>(key));
-		auto it2 = containerVK.lower_bound(pair2);
-		containerKV.erase(it);
-		containerVK.erase(it2);
-		insert(key, value);
+	}
+
+	/*Metody zmieniające wartość przypisaną kluczowi key jak changeValue;
+	  zwracają false, nic nie zmieniając, gdy klucza nie ma w kolejce
+	  Złożoność: O(log size())
+	  Exception safety: strong */
+	bool tryChangeValue(const K &key, const V &value) {
+		return changeKeyValue(key, value);
+	}
+
+	bool tryChangeValue(const K &key, V &&value) {
+		return changeKeyValue(key, std::move(value));
+	}
+
+	/*Metoda zmieniająca wartość pary wskazywanej przez uchwyt na value; węzeł
+	  jest przepinany w obu drzewach bez przydzielania pamięci, a uchwyt
+	  pozostaje ważny. Gdy istnieje migawka, kolejka najpierw kopiuje pary jak
+	  każda modyfikacja, a wszystkie dotychczasowe uchwyty, także h, tracą
+	  ważność; zwracany uchwyt wskazuje na zmienioną parę w obu przypadkach.
+	  Wymaga, aby przypisanie przenoszące V nie zgłaszało wyjątków.
+	  Złożoność: O(log size()), a O(size()) przy kopiowaniu
+	  Exception safety: strong */
+	handle changeValue(handle h, const V &value) {
+		static_assert(std::is_nothrow_move_assignable<V>::value,
+		              "changeValue(handle, value) requires V with no-throw move assignment");
+		stats_mark started = statistics.start();
+		V replacement(value);
+		detach(&h.target);
+		reposition(h.target, replacement);
+		record(PriorityQueueEvent::changeHit, 1, started);
+		return h;
+	}
+
+	/*Metoda usuwająca z kolejki parę wskazywaną przez uchwyt; gdy istnieje
+	  migawka, kolejka najpierw kopiuje pary i usuwa kopię pary h, jak
+	  w changeValue(handle, value)
+	  Złożoność: O(log size()), a O(size()) przy kopiowaniu
+	  Exception safety: strong (no-throw, gdy nie ma migawki) */
+	void erase(handle h) {
+		stats_mark started = statistics.start();
+		detach(&h.target);
+		unlinkNode(h.target);
+		destroyNode(h.target);
+		record(PriorityQueueEvent::erase, 1, started);
+	}
+
+	/*Metoda zwracająca true wtedy i tylko wtedy, gdy w kolejce jest para o kluczu key
+	  Złożoność: O(log size()), średnio O(1) z PriorityQueueHashLookup
+	  Exception safety: strong */
+	bool contains(const K &key) const {
+		return findKey(key) != nullptr;
+	}
+
+	/*Metoda zwracająca liczbę par o kluczu key
+	  Złożoność: O(log size() + wynik), średnio O(1 + wynik) z PriorityQueueHashLookup
+	  Exception safety: strong */
+	size_type count(const K &key) const {
+		size_type result = 0;
+		for (node *x = findKey(key); x && !(key < x->key); x = next<key_hook>(x)) {
+			result++;
+		}
+		return result;
+	}
+
+	/*Metoda zwracająca widok na wszystkie pary o kluczu key w porządku kluczy
+	  (przy równych kluczach według wartości); dla brakującego klucza widok jest pusty
+	  Złożoność: O(log size() + wynik), średnio O(1 + wynik) z PriorityQueueHashLookup
+	  Exception safety: strong */
+	key_range equalRangeByKey(const K &key) const {
+		node *from = findKey(key);
+		node *to = from;
+		while (to && !(key < to->key)) {
+			to = next<key_hook>(to);
+		}
+		return key_range(const_key_iterator(from, &containerKV), const_key_iterator(to, &containerKV));
+	}
+
+	/*Metoda zmieniająca wartość wszystkich par o kluczu key na value; zwraca
+	  liczbę zmienionych par. Pary o tym kluczu tworzą spójny fragment porządku
+	  kluczy, który po zmianie zostaje na miejscu, więc przepinane są tylko
+	  w drzewie wartości, razem, przed jednym wyszukanym miejscem, bez
+	  przydzielania pamięci na węzły. Wymaga, aby przypisanie przenoszące V nie
+	  zgłaszało wyjątków; gdy kopiujące może je zgłaszać, kopie value są
+	  tworzone zawczasu.
+	  Złożoność: O(log size() + wynik) porównań, O((1 + wynik) log size()) czasu
+	  Exception safety: strong */
+	size_type changeAllValues(const K &key, const V &value) {
+		static_assert(std::is_nothrow_move_assignable<V>::value,
+		              "changeAllValues requires V with no-throw move assignment");
+		stats_mark started = statistics.start();
+		if (!findKey(key)) {
+			record(PriorityQueueEvent::changeMiss, 1, started);
+			return 0;
+		}
+		detach();
+		node_vector run;
+		for (node *x = findKey(key); x && !(key < x->key); x = next<key_hook>(x)) {
+			run.push_back(x);
+		}
+		// pierwszy węzeł spoza fragmentu, przed którym leży para (value, key)
+		node *posVK = upperVK(value, key);
+		while (posVK && !(posVK->key < key) && !(key < posVK->key)) {
+			posVK = next<value_hook>(posVK);
+		}
+		replacement_values replacements(run.size(), value);
+		for (std::size_t i = 0; i < run.size(); i++) {
+			node *x = run[i];
+			unlink<value_hook>(containerVK, x);
+			digest -= pairDigest(x);
+			replacements.assign(x->value, i);
+			digest += pairDigest(x);
+			stamp(x, ++seed);
+		}
+		for (node *x : run) {
+			linkBefore<value_hook>(containerVK, x, posVK);
+		}
+		record(PriorityQueueEvent::changeHit, run.size(), started);
+		return run.size();
+	}
+
+	/*Metoda usuwająca z kolejki wszystkie pary o kluczu key; zwraca liczbę usuniętych par.
+	  Gdy klucza nie ma, kolejka współdzieląca pary z migawką nie jest kopiowana.
+	  Złożoność: O((1 + wynik) log size())
+	  Exception safety: strong */
+	size_type erase(const K &key) {
+		stats_mark started = statistics.start();
+		if (!findKey(key)) {
+			record(PriorityQueueEvent::erase, 0, started);
+			return 0;
+		}
+		detach();
+		node *x = findKey(key);
+		size_type removed = 0;
+		for (node *y = x; y && !(key < y->key); y = next<key_hook>(y)) {
+			removed++;
+		}
+		for (size_type i = 0; i < removed; i++) {
+			node *following = next<key_hook>(x);
+			unlinkNode(x);
+			destroyNode(x);
+			x = following;
+		}
+		record(PriorityQueueEvent::erase, removed, started);
+		return removed;
 	}
 
 	/*Metoda scalająca zawartość kolejki z podaną kolejką queue; ta operacja usuwa
-	  wszystkie elementy z kolejki queue i wstawia je do kolejki *this
-	  Złożoność: O(size() + queue.size() * log (queue.size() + size()))
+	  wszystkie elementy z kolejki queue i wstawia je do kolejki *this; gdy
+	  alokatory są równe, węzły są przepinane bez przydzielania pamięci
+	  Złożoność: O(size() + queue.size())
+	  Exception safety: strong */
+	void merge(PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &queue) {
+		merge(PriorityQueueSequential(), queue);
+	}
+
+	/*Metoda scalająca jak merge(queue); gdy oba porządki są scalane liniowo,
+	  każdy z nich jest scalany i budowany zgodnie z polityką wykonania policy
+	  (np. PriorityQueueParallel)
+	  Złożoność: O(size() + queue.size())
 	  Exception safety: strong */
-	void merge(PriorityQueue<K, V> &queue) {
+	template<typename Policy, typename = execution_policy<Policy>>
+	void merge(const Policy &policy, PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &queue) {
 		if (&queue == this) {
 			return;
 		}
-		while (!queue.empty()) {
-			containerKV.insert(*queue.containerKV.begin());
-			queue.containerKV.erase(queue.containerKV.begin());
-			containerVK.insert(*queue.containerVK.begin());
-			queue.containerVK.erase(queue.containerVK.begin());
+		stats_mark started = statistics.start();
+		detach();
+		if (alloc == queue.alloc) {
+			queue.detach();
+			spliceAll(queue, policy);
+		}
+		else {
+			PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> copy(queue, alloc);
+			size_type copied = copy.size();
+			spliceAll(copy, policy);
+			queue.clear();
+			record(PriorityQueueEvent::allocate, copied, started);
+		}
+		record(PriorityQueueEvent::merge, 1, started);
+		trim(started);
+	}
+
+	/*Metoda przenosząca z kolejki do nowej kolejki, którą zwraca, wszystkie
+	  pary o wartości nie mniejszej niż pivot (odwrotność merge); węzły są
+	  przepinane bez przydzielania pamięci, a uchwyty do przeniesionych par
+	  wskazują na pary w nowej kolejce
+	  Złożoność: O(log size() + m log m) oczekiwana dla m przeniesionych par,
+	  a O(size()) gdy m jest porównywalne z size()
+	  Exception safety: strong */
+	PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> splitByValue(const V &pivot) {
+		stats_mark started = statistics.start();
+		detach();
+		PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> result{Alloc(alloc)};
+		splitFrom<value_hook, key_hook>(result, lowerValue(pivot), nodeLessKV,
+			[&pivot](const node *x) { return !(x->value < pivot); });
+		record(PriorityQueueEvent::split, 1, started);
+		return result;
+	}
+
+	/*Metoda przenosząca z kolejki do nowej kolejki, którą zwraca, wszystkie
+	  pary o kluczu nie mniejszym niż pivot
+	  Złożoność: O(log size() + m log m) oczekiwana dla m przeniesionych par,
+	  a O(size()) gdy m jest porównywalne z size()
+	  Exception safety: strong */
+	PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> splitByKey(const K &pivot) {
+		stats_mark started = statistics.start();
+		detach();
+		PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> result{Alloc(alloc)};
+		splitFrom<key_hook, value_hook>(result, lowerKey(pivot), nodeLessVK,
+			[&pivot](const node *x) { return !(x->key < pivot); });
+		record(PriorityQueueEvent::split, 1, started);
+		return result;
+	}
+
+	/*Metoda zapisująca kolejkę do pliku path w formacie PriorityQueueFileHeader;
+	  plik jest najpierw zapisywany pod nazwą path + ".tmp" i dopiero potem
+	  podmieniany, więc poprzedni zapis nie ginie przy błędzie. K i V muszą być
+	  trywialnie kopiowalne. Rzuca PriorityQueueFileException przy błędzie zapisu.
+	  Złożoność: O(size())
+	  Exception safety: strong */
+	void save(const std::string &path) const {
+		static_assert(std::is_trivially_copyable<K>::value && std::is_trivially_copyable<V>::value,
+		              "save requires trivially copyable K and V");
+		std::string temporary = path + ".tmp";
+		file_handle file(std::fopen(temporary.c_str(), "wb"));
+		if (!file) {
+			throw PriorityQueueFileException();
+		}
+		try {
+			saveTo(file.get());
+			if (std::fclose(file.release()) != 0) {
+				throw PriorityQueueFileException();
+			}
+			if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+				throw PriorityQueueFileException();
+			}
+		}
+		catch (...) {
+			file.reset();
+			std::remove(temporary.c_str());
+			throw;
+		}
+	}
+
+	/*Metoda tworząca kolejkę z pliku zapisanego przez save; rzuca
+	  PriorityQueueFileException, gdy pliku nie da się przeczytać albo nie
+	  pasuje do typów K i V
+	  Złożoność: O(n) dla n par w pliku
+	  Exception safety: strong */
+	static PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> load(const std::string &path, const Alloc &allocator = Alloc()) {
+		static_assert(std::is_trivially_copyable<K>::value && std::is_trivially_copyable<V>::value,
+		              "load requires trivially copyable K and V");
+		file_handle file(std::fopen(path.c_str(), "rb"));
+		if (!file) {
+			throw PriorityQueueFileException();
+		}
+		PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> result(allocator);
+		result.loadFrom(file.get());
+		return result;
+	}
+
+	/*Metoda zwracająca migawkę: niezmienną kolejkę o obecnej zawartości, z której
+	  można czytać również w innych wątkach. Migawka współdzieli węzły z kolejką,
+	  więc kolejne migawki przed modyfikacją kosztują O(1). Pierwsza modyfikacja
+	  kolejki, gdy migawka nadal istnieje, kopiuje pary w O(size()); gdy migawki
+	  już nie ma, kolejka odzyskuje węzły w O(1). Kopiowanie przy pierwszej
+	  modyfikacji unieważnia wcześniejsze uchwyty do par kolejki; uchwyt
+	  przekazany do changeValue(handle, value) albo erase(handle) jest
+	  przedtem odnajdywany wśród kopii, a nowy uchwyt zwraca changeValue.
+	  Złożoność: O(1)
+	  Exception safety: strong */
+	snapshot_type snapshot() {
+		if (!frozen) {
+			std::shared_ptr<PriorityQueue> body = std::allocate_shared<PriorityQueue>(
+				rebind_alloc<PriorityQueue>(alloc), Alloc(alloc));
+			body->containerKV = containerKV;
+			body->containerVK = containerVK;
+			body->elements = elements;
+			body->seed = seed;
+			body->digest = digest;
+			body->keyIndex.swap(keyIndex);
+			frozen = std::move(body);
 		}
+		return frozen;
 	}
 
 	/*Metoda zamieniającą zawartość kolejki z podaną kolejką queue (tak jak
       większość kontenerów w bibliotece standardowej)
 	  Złożoność: O(1)
 	  Exception safety: no-throw */
-	void swap(PriorityQueue<K, V> &queue) {
-		containerKV.swap(queue.containerKV);
-		containerVK.swap(queue.containerVK);
+	void swap(PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &queue) noexcept {
+		using std::swap;
+		if (node_traits::propagate_on_container_swap::value) {
+			swap(alloc, queue.alloc);
+		}
+		swap(containerKV, queue.containerKV);
+		swap(containerVK, queue.containerVK);
+		swap(elements, queue.elements);
+		swap(limit, queue.limit);
+		swap(seed, queue.seed);
+		swap(digest, queue.digest);
+		keyIndex.swap(queue.keyIndex);
+		swap(frozen, queue.frozen);
 	}
 
-	/*Operator porównania
-	  Złożoność: O(size())
+	/*Metoda zwracająca skrót zawartości kolejki, niezależny od kolejności
+	  wstawiania par; równe kolejki mają równe skróty. Dostępna, gdy std::hash
+	  dla K i V istnieje i nie zgłasza wyjątków.
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	std::uint64_t contentHash() const noexcept {
+		static_assert(digested, "contentHash requires std::hash<K> and std::hash<V> that do not throw");
+		return digest;
+	}
+
+	/*Operator porównania; kolejki o różnych rozmiarach albo skrótach zawartości
+	  oraz kolejki współdzielące węzły (migawki) są rozstrzygane bez porównywania par
+	  Złożoność: O(size()), a O(1) gdy kolejki na pewno są różne
 	  Exception safety: strong */
 	bool operator==(const PriorityQueue &queue) const {
-		if (size() != queue.size()) {
+		if (size() != queue.size() || digest != queue.digest) {
 			return false;
 		}
-		auto it = queue.containerKV.begin();
-		cmp<key_value> comparator;
-		for (auto it2 = containerKV.begin(); it2 != containerKV.end(); it++, it2++) {
-			if (comparator(*it, *it2) || comparator(*it2, *it)) {
+		if (containerKV.root == queue.containerKV.root) {
+			return true;
+		}
+		node *it = queue.containerKV.first;
+		for (node *it2 = containerKV.first; it2; it = next<key_hook>(it), it2 = next<key_hook>(it2)) {
+			if (!(it->key == it2->key) || !(it->value == it2->value)) {
 				return false;
 			}
 		}
 		return true;
 	}
 
-	/*Operator porównania
+	/*Operator porównania leksykograficznego ciągów par w porządku kluczy;
+	  każdy krok porównuje klucze, a wartości tylko przy równych kluczach
 	  Złożoność: O(size())
 	  Exception safety: strong */
 	bool operator<(const PriorityQueue &queue) const {
-		if (empty() || queue.empty()) {
-			return containerKV < queue.containerKV; 
-		}
-		auto it = containerKV.begin();
-		auto it2 = queue.containerKV.begin();
-		cmp<key_value> comparator;
-		for (; it != containerKV.end() && it2 != queue.containerKV.end(); it++, it2++) {
-			if (comparator(*it, *it2)) {
+		if (containerKV.root == queue.containerKV.root) {
+			return false;
+		}
+		node *it = containerKV.first;
+		node *it2 = queue.containerKV.first;
+		for (; it && it2; it = next<key_hook>(it), it2 = next<key_hook>(it2)) {
+			if (it->key < it2->key) {
 				return true;
 			}
-			if (comparator(*it2, *it)) {
+			if (it2->key < it->key) {
+				return false;
+			}
+			if (it->value < it2->value) {
+				return true;
+			}
+			if (it2->value < it->value) {
 				return false;
 			}
 		}
-		if (size() != queue.size()) {
-			return size() < queue.size();
-		}
-		return false;
+		return size() < queue.size();
 	}
 };
 
+template<typename K, typename V, typename Alloc, typename Lookup, typename Stats, typename TieBreak>
+constexpr typename PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak>::size_type PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak>::node_size;
+
 /*Operator porównania
   Złożoność: O(size())
   Exception safety: strong */
-template<typename K, typename V>
-bool operator!=(const PriorityQueue<K, V> &first, const PriorityQueue<K, V> &second) {
+template<typename K, typename V, typename Alloc, typename Lookup, typename Stats, typename TieBreak>
+bool operator!=(const PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &first, const PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &second) {
 	return !(first == second);
 }
 
 /*Operator porównania
   Złożoność: O(size())
   Exception safety: strong */
-template<typename K, typename V>
-bool operator>(const PriorityQueue<K, V> &first, const PriorityQueue<K, V> &second) {
+template<typename K, typename V, typename Alloc, typename Lookup, typename Stats, typename TieBreak>
+bool operator>(const PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &first, const PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &second) {
 	return second < first;
 }
 
 /*Operator porównania
   Złożoność: O(size())
   Exception safety: strong */
-template<typename K, typename V>
-bool operator>=(const PriorityQueue<K, V> &first, const PriorityQueue<K, V> &second) {
+template<typename K, typename V, typename Alloc, typename Lookup, typename Stats, typename TieBreak>
+bool operator>=(const PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &first, const PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &second) {
 	return !(first < second);
 }
 
 /*Operator porównania
   Złożoność: O(size())
   Exception safety: strong */
-template<typename K, typename V>
-bool operator<=(const PriorityQueue<K, V> &first, const PriorityQueue<K, V> &second) {
+template<typename K, typename V, typename Alloc, typename Lookup, typename Stats, typename TieBreak>
+bool operator<=(const PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &first, const PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &second) {
 	return !(second < first);
 }
 
 /*Funkcja zamieniającą zawartość dwóch kolejek
   Złożoność: O(1)
   Exception safety: no-throw */
-template<typename K, typename V>
-void swap(PriorityQueue<K, V> &first, PriorityQueue<K, V> &second) {
+template<typename K, typename V, typename Alloc, typename Lookup, typename Stats, typename TieBreak>
+void swap(PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &first, PriorityQueue<K, V, Alloc, Lookup, Stats, TieBreak> &second) {
 	first.swap(second);
 }
 
-#endif //PRIORITYQUEUE_HH
\ No newline at end of file
+#endif //PRIORITYQUEUE_HH
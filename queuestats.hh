@@ -0,0 +1,81 @@
+#ifndef QUEUESTATS_HH
+#define QUEUESTATS_HH
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "priorityqueue.hh"
+
+/*Polityka statystyk zliczająca zdarzenia i największy rozmiar kolejki, np.
+  PriorityQueue<K, V, std::allocator<std::pair<const K, V>>,
+                PriorityQueueTreeLookup, PriorityQueueCountingStats>.
+  Każde zdarzenie to jedno dodawanie do licznika obiektu kolejki, bez
+  synchronizacji (jak cała kolejka). */
+class PriorityQueueCountingStats {
+public:
+	int start() const noexcept {
+		return 0;
+	}
+
+	void record(PriorityQueueEvent event, std::size_t count, std::size_t size, int) noexcept {
+		counted(event, count, size);
+	}
+
+	void collect(PriorityQueueStats &stats) const noexcept {
+		for (std::size_t i = 0; i < PriorityQueueEventCount; i++) {
+			stats.events[i] = events[i];
+		}
+		stats.peakSize = peakSize;
+	}
+
+protected:
+	void counted(PriorityQueueEvent event, std::size_t count, std::size_t size) noexcept {
+		events[static_cast<unsigned>(event)] += count;
+		if (peakSize < size) {
+			peakSize = size;
+		}
+	}
+
+private:
+	std::uint64_t events[PriorityQueueEventCount] = {};
+	std::size_t peakSize = 0;
+};
+
+/*Polityka statystyk, która poza zliczaniem mierzy czas każdej operacji
+  (std::chrono::steady_clock) i zapisuje go w histogramie o przedziałach
+  będących kolejnymi potęgami dwójki nanosekund. Operacja obejmująca wiele
+  zdarzeń (np. popMin(n, out)) daje jeden pomiar. */
+class PriorityQueueTimedStats : public PriorityQueueCountingStats {
+public:
+	using clock = std::chrono::steady_clock;
+
+	clock::time_point start() const noexcept {
+		return clock::now();
+	}
+
+	void record(PriorityQueueEvent event, std::size_t count, std::size_t size, clock::time_point started) noexcept {
+		counted(event, count, size);
+		std::uint64_t nanoseconds = static_cast<std::uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - started).count());
+		std::size_t bucket = 0;
+		for (; nanoseconds > 1 && bucket + 1 < PriorityQueueLatencyBuckets; nanoseconds >>= 1) {
+			bucket++;
+		}
+		latency[static_cast<unsigned>(event)][bucket]++;
+	}
+
+	void collect(PriorityQueueStats &stats) const noexcept {
+		PriorityQueueCountingStats::collect(stats);
+		for (std::size_t i = 0; i < PriorityQueueEventCount; i++) {
+			for (std::size_t b = 0; b < PriorityQueueLatencyBuckets; b++) {
+				stats.latency[i][b] = latency[i][b];
+			}
+		}
+	}
+
+private:
+	std::uint64_t latency[PriorityQueueEventCount][PriorityQueueLatencyBuckets] = {};
+};
+
+#endif //QUEUESTATS_HH
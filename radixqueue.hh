@@ -0,0 +1,314 @@
+#ifndef RADIXQUEUE_HH
+#define RADIXQUEUE_HH
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "priorityqueue.hh"
+
+struct PriorityQueueMonotoneException : public std::exception {
+	virtual const char *what() const noexcept {
+		return "PriorityQueueMonotoneException";
+	}
+};
+
+/*Monotoniczna kolejka priorytetowa (kopiec pozycyjny, radix heap) dla
+  całkowitych V, np. czasów zdarzeń w kolejce timerów: wartość wstawiana albo
+  ustawiana przez changeValue nie może być mniejsza od ostatniego minimum
+  (odczytanego przez minValue/minKey albo usuniętego przez deleteMin), inaczej
+  rzucany jest PriorityQueueMonotoneException. Pary są trzymane w koszykach
+  według najwyższego bitu, którym ich wartość różni się od ostatniego minimum;
+  każda para przechodzi do niższego koszyka najwyżej tyle razy, ile bitów ma V,
+  więc insert i deleteMin kosztują zamortyzowane O(1) zamiast O(log size()).
+  Interfejs to podzbiór PriorityQueue<K, V>: insert, minValue, minKey,
+  deleteMin i changeValue, bez operacji na największej wartości. Pary o równych
+  wartościach są zdejmowane w nieokreślonej kolejności. Węzły par są węzłami
+  haszowego indeksu kluczy, więc każda para to jedna alokacja. Metody stałe
+  mogą przenosić pary między koszykami, więc obiekt, jak PriorityQueue, nie
+  może być używany z wielu wątków naraz. */
+template<typename K, typename V, typename Hash = std::hash<K>>
+class RadixPriorityQueue {
+	static_assert(std::is_integral<V>::value, "RadixPriorityQueue requires integral V");
+
+	struct entry;
+	using key_index = std::unordered_multimap<K, entry, Hash>;
+	using item = typename key_index::value_type;
+	using bits_type = typename std::make_unsigned<V>::type;
+
+	/*Wartość pary i jej miejsce na liście koszyka */
+	struct entry {
+		V value;
+		std::size_t bucket;
+		item *prev;
+		item *next;
+	};
+
+	static const std::size_t bits = std::numeric_limits<bits_type>::digits;
+
+	key_index index;
+	/*Koszyk 0 zawiera pary o wartości równej ostatniemu minimum, a koszyk
+	  i > 0 pary, których wartość różni się od niego najwyżej na bicie i - 1 */
+	mutable item *buckets[bits + 1] = {};
+	mutable bits_type last = 0;
+
+	/*Wartość przesunięta tak, żeby porządek liczb ze znakiem zgadzał się
+	  z porządkiem liczb bez znaku */
+	static bits_type encode(V value) noexcept {
+		const bits_type sign = std::is_signed<V>::value ? bits_type(bits_type(1) << (bits - 1)) : bits_type(0);
+		return bits_type(static_cast<bits_type>(value) ^ sign);
+	}
+
+	std::size_t bucketOf(bits_type u) const noexcept {
+		bits_type difference = bits_type(u ^ last);
+		std::size_t result = 0;
+		for (std::size_t shift = bits / 2; shift; shift /= 2) {
+			if (difference >> shift) {
+				difference = bits_type(difference >> shift);
+				result += shift;
+			}
+		}
+		return difference ? result + 1 : 0;
+	}
+
+	void link(item *x, std::size_t bucket) const noexcept {
+		x->second.bucket = bucket;
+		x->second.prev = nullptr;
+		x->second.next = buckets[bucket];
+		if (buckets[bucket]) {
+			buckets[bucket]->second.prev = x;
+		}
+		buckets[bucket] = x;
+	}
+
+	void unlink(item *x) const noexcept {
+		if (x->second.prev) {
+			x->second.prev->second.next = x->second.next;
+		}
+		else {
+			buckets[x->second.bucket] = x->second.next;
+		}
+		if (x->second.next) {
+			x->second.next->second.prev = x->second.prev;
+		}
+	}
+
+	/*Gdy koszyk 0 jest pusty, ustawia ostatnie minimum na najmniejszą wartość
+	  w pierwszym niepustym koszyku i rozdziela ten koszyk na niższe */
+	void settle() const noexcept {
+		if (buckets[0] || index.empty()) {
+			return;
+		}
+		std::size_t i = 1;
+		while (!buckets[i]) {
+			i++;
+		}
+		bits_type smallest = encode(buckets[i]->second.value);
+		for (item *x = buckets[i]->second.next; x; x = x->second.next) {
+			if (encode(x->second.value) < smallest) {
+				smallest = encode(x->second.value);
+			}
+		}
+		last = smallest;
+		item *x = buckets[i];
+		buckets[i] = nullptr;
+		while (x) {
+			item *following = x->second.next;
+			link(x, bucketOf(encode(x->second.value)));
+			x = following;
+		}
+	}
+
+	const item &front() const {
+		if (empty()) {
+			throw PriorityQueueEmptyException();
+		}
+		settle();
+		return *buckets[0];
+	}
+
+	typename key_index::iterator locate(const item *x) {
+		auto range = index.equal_range(x->first);
+		while (&*range.first != x) {
+			++range.first;
+		}
+		return range.first;
+	}
+
+	void checkMonotone(bits_type u) const {
+		if (u < last) {
+			throw PriorityQueueMonotoneException();
+		}
+	}
+
+	void copyFrom(const RadixPriorityQueue<K, V, Hash> &queue) {
+		index.reserve(queue.size());
+		for (std::size_t b = 0; b <= bits; b++) {
+			for (const item *x = queue.buckets[b]; x; x = x->second.next) {
+				auto it = index.emplace(x->first, entry{x->second.value, 0, nullptr, nullptr});
+				link(&*it, b);
+			}
+		}
+		last = queue.last;
+	}
+
+public:
+	using size_type = std::size_t;
+	using key_type = K;
+	using value_type = V;
+
+	/*Konstruktor bezparametrowy tworzący pustą kolejkę
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	RadixPriorityQueue() = default;
+
+	/*Konstruktor kopiujący
+	  Złożoność: O(queue.size())
+	  Exception safety: strong */
+	RadixPriorityQueue(const RadixPriorityQueue<K, V, Hash> &queue) {
+		copyFrom(queue);
+	}
+
+	/*Konstruktor przenoszący
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	RadixPriorityQueue(RadixPriorityQueue<K, V, Hash> &&queue) noexcept {
+		swap(queue);
+	}
+
+	/*Operator przypisania dla użycia P = Q
+	  Złożoność: O(queue.size())
+	  Exception safety: strong */
+	RadixPriorityQueue<K, V, Hash> &operator=(const RadixPriorityQueue<K, V, Hash> &queue) {
+		if (&queue != this) {
+			RadixPriorityQueue<K, V, Hash> copy(queue);
+			swap(copy);
+		}
+		return *this;
+	}
+
+	/*Operator przypisania dla użycia P = move(Q)
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	RadixPriorityQueue<K, V, Hash> &operator=(RadixPriorityQueue<K, V, Hash> &&queue) noexcept {
+		swap(queue);
+		return *this;
+	}
+
+	/*Metoda zwracająca true wtedy i tylko wtedy, gdy kolejka jest pusta
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	bool empty() const noexcept {
+		return index.empty();
+	}
+
+	/*Metoda zwracająca liczbę par (klucz, wartość) przechowywanych w kolejce
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	size_type size() const noexcept {
+		return index.size();
+	}
+
+	/*Metoda wstawiająca do kolejki parę o kluczu key i wartości value; rzuca
+	  PriorityQueueMonotoneException, gdy value jest mniejsza od ostatniego minimum
+	  Złożoność: O(1) średnio
+	  Exception safety: strong */
+	void insert(const K &key, const V &value) {
+		bits_type u = encode(value);
+		checkMonotone(u);
+		auto it = index.emplace(key, entry{value, 0, nullptr, nullptr});
+		link(&*it, bucketOf(u));
+	}
+
+	/*Metody zwracające najmniejszą wartość i przypisany jej klucz; rzucają
+	  PriorityQueueEmptyException dla pustej kolejki
+	  Złożoność: O(1) zamortyzowana
+	  Exception safety: strong */
+	const V &minValue() const {
+		return front().second.value;
+	}
+
+	const K &minKey() const {
+		return front().first;
+	}
+
+	/*Metoda usuwająca z kolejki jedną parę o najmniejszej wartości
+	  Złożoność: O(1) zamortyzowana, średnio
+	  Exception safety: strong */
+	void deleteMin() {
+		if (empty()) {
+			return;
+		}
+		settle();
+		item *x = buckets[0];
+		auto it = locate(x);
+		unlink(x);
+		index.erase(it);
+	}
+
+	/*Metoda zmieniająca dotychczasową wartość przypisaną kluczowi key na nową
+	  wartość value (dla wielu par o tym kluczu: wartość najmniejszą, jak
+	  w PriorityQueue); rzuca PriorityQueueNotFoundException, gdy klucza nie
+	  ma w kolejce, a PriorityQueueMonotoneException, gdy value jest mniejsza
+	  od ostatniego minimum
+	  Złożoność: O(1 + liczba par o kluczu key) średnio
+	  Exception safety: strong */
+	void changeValue(const K &key, const V &value) {
+		auto range = index.equal_range(key);
+		if (range.first == range.second) {
+			throw PriorityQueueNotFoundException();
+		}
+		bits_type u = encode(value);
+		checkMonotone(u);
+		auto chosen = range.first;
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second.value < chosen->second.value) {
+				chosen = it;
+			}
+		}
+		item *x = &*chosen;
+		unlink(x);
+		x->second.value = value;
+		link(x, bucketOf(u));
+	}
+
+	/*Metoda zwracająca true wtedy i tylko wtedy, gdy w kolejce jest para o kluczu key
+	  Złożoność: O(1) średnio
+	  Exception safety: strong */
+	bool contains(const K &key) const {
+		return index.find(key) != index.end();
+	}
+
+	/*Metoda zwracająca liczbę par o kluczu key
+	  Złożoność: O(1 + wynik) średnio
+	  Exception safety: strong */
+	size_type count(const K &key) const {
+		return index.count(key);
+	}
+
+	/*Metoda zamieniającą zawartość kolejki z podaną kolejką queue
+	  Złożoność: O(1)
+	  Exception safety: no-throw */
+	void swap(RadixPriorityQueue<K, V, Hash> &queue) noexcept {
+		using std::swap;
+		index.swap(queue.index);
+		for (std::size_t b = 0; b <= bits; b++) {
+			swap(buckets[b], queue.buckets[b]);
+		}
+		swap(last, queue.last);
+	}
+};
+
+/*Funkcja zamieniającą zawartość dwóch kolejek
+  Złożoność: O(1)
+  Exception safety: no-throw */
+template<typename K, typename V, typename Hash>
+void swap(RadixPriorityQueue<K, V, Hash> &first, RadixPriorityQueue<K, V, Hash> &second) {
+	first.swap(second);
+}
+
+#endif //RADIXQUEUE_HH
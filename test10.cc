@@ -0,0 +1,251 @@
+#include <iostream>
+#include <exception>
+#include <cassert>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+#include "flatqueue.hh"
+
+using Flat = FlatPriorityQueue<int, int>;
+
+Flat f(Flat q)
+{
+    return q;
+}
+
+void testExample() {
+    Flat P = f(Flat());
+    assert(P.empty());
+
+    P.insert(1, 42);
+    P.insert(2, 13);
+
+    assert(P.size() == 2);
+    assert(P.maxKey() == 1);
+    assert(P.maxValue() == 42);
+    assert(P.minKey() == 2);
+    assert(P.minValue() == 13);
+
+    Flat Q(f(P));
+
+    Q.deleteMax();
+    Q.deleteMin();
+    Q.deleteMin();
+
+    assert(Q.empty());
+
+    Flat R(Q);
+
+    R.insert(1, 100);
+    R.insert(2, 100);
+    R.insert(3, 300);
+
+    Flat S;
+    S = R;
+
+    try {
+        S.changeValue(4, 400);
+        assert(!"did not throw");
+    }
+    catch (const PriorityQueueNotFoundException &) {
+    }
+
+    S.changeValue(2, 200);
+    assert(S.minValue() == 100);
+    assert(S.minKey() == 1);
+
+    try {
+        while (true) {
+            S.minValue();
+            S.deleteMin();
+        }
+    }
+    catch (const PriorityQueueEmptyException &) {
+    }
+
+    Flat T;
+    T.insert(1, 1);
+    T.insert(2, 4);
+    S.insert(3, 9);
+    S.insert(4, 16);
+    S.merge(T);
+    assert(S.size() == 4);
+    assert(S.minValue() == 1);
+    assert(S.maxValue() == 16);
+    assert(T.empty());
+
+    S = R;
+    swap(R, T);
+    assert(T == S);
+    assert(T != R);
+    assert(R < T);
+
+    R = std::move(S);
+    assert(T == R);
+}
+
+void testRanges() {
+    std::vector<std::pair<int, int>> pairs = {{5, 50}, {1, 10}, {3, 30}, {3, 5}, {4, 40}};
+    Flat P(pairs.begin(), pairs.end());
+    assert(P.size() == 5 && P.count(3) == 2 && P.contains(4) && !P.contains(2));
+    assert(P.minKey() == 3 && P.minValue() == 5);
+
+    std::vector<int> keys;
+    for (auto p : P.keyRange(2, 5)) {
+        keys.push_back(p.first);
+    }
+    assert((keys == std::vector<int>{3, 3, 4}));
+    std::vector<int> values;
+    for (auto p : P.valueRange(10, 40)) {
+        values.push_back(p.second);
+    }
+    assert((values == std::vector<int>{10, 30}));
+    assert(P.keyRange(4, 2).empty());
+
+    // changeValue zmienia najmniejszą wartość klucza, jak w PriorityQueue
+    P.changeValue(3, 70);
+    auto it = P.keyRange(3, 4).begin();
+    assert(it.value() == 30 && (++it).value() == 70);
+    assert(P.maxKey() == 3 && P.minKey() == 1);
+
+    P.insert(pairs.begin(), pairs.end());
+    assert(P.size() == 10 && P.count(3) == 4 && P.minValue() == 5 && P.maxValue() == 70);
+    P.deleteMin();
+    assert(P.minKey() == 1 && P.minValue() == 10);
+}
+
+void testFreeze() {
+    std::mt19937 twister(7);
+    PriorityQueue<int, int> tree;
+    for (int i = 0; i < 5000; i++) {
+        tree.insert(static_cast<int>(twister() % 300), static_cast<int>(twister() % 100));
+    }
+    Flat P = freeze(tree);
+    assert(P.size() == tree.size());
+    auto it = tree.keyBegin();
+    for (auto p : P.byKey()) {
+        assert(p.first == it.key() && p.second == it.value());
+        ++it;
+    }
+    auto jt = tree.valueBegin();
+    for (auto p : P.byValue()) {
+        assert(p.first == jt.key() && p.second == jt.value());
+        ++jt;
+    }
+
+    PriorityQueue<int, int, std::allocator<std::pair<const int, int>>, PriorityQueueHashLookup<>> hashed;
+    hashed.insert(2, 1);
+    hashed.insert(1, 1);
+    Flat Q = freeze(hashed, std::allocator<std::pair<int, int>>());
+    assert(Q.minKey() == 1 && Q.maxKey() == 2 && P < Q);
+
+    // w trybie FIFO równe wartości zostają w kolejności wstawienia
+    PriorityQueue<int, int, std::allocator<std::pair<const int, int>>, PriorityQueueTreeLookup,
+                  PriorityQueueNoStats, PriorityQueueFifoTieBreak> fifo;
+    fifo.insert(3, 1);
+    fifo.insert(1, 1);
+    fifo.insert(2, 1);
+    auto F = freeze(fifo);
+    assert(F.minKey() == 3 && F.maxKey() == 2);
+    F.insert(0, 1);
+    F.changeValue(3, 1);
+    assert(F.minKey() == 1 && F.maxKey() == 3);
+}
+
+// FlatPriorityQueue ma dawać te same wyniki co PriorityQueue, także dla
+// powtarzających się kluczy i w trybie FIFO
+template<typename TieBreak>
+void testAgainstTree() {
+    std::mt19937 twister(42);
+    PriorityQueue<int, std::string, std::allocator<std::pair<const int, std::string>>,
+                  PriorityQueueTreeLookup, PriorityQueueNoStats, TieBreak> tree, treeOther;
+    FlatPriorityQueue<int, std::string, std::allocator<std::pair<int, std::string>>, TieBreak> flat, flatOther;
+    for (int i = 0; i < 30000; i++) {
+        int key = static_cast<int>(twister() % 2000);
+        std::string value = std::to_string(twister() % 300);
+        switch (twister() % 8) {
+            case 0:
+            case 1:
+            case 2:
+                tree.insert(key, value);
+                flat.insert(key, value);
+                break;
+            case 3:
+                tree.deleteMin();
+                flat.deleteMin();
+                break;
+            case 4:
+                tree.deleteMax();
+                flat.deleteMax();
+                break;
+            case 5: {
+                bool treeFound = true, flatFound = true;
+                try {
+                    tree.changeValue(key, value);
+                }
+                catch (PriorityQueueNotFoundException &) {
+                    treeFound = false;
+                }
+                try {
+                    flat.changeValue(key, value);
+                }
+                catch (PriorityQueueNotFoundException &) {
+                    flatFound = false;
+                }
+                assert(treeFound == flatFound);
+                break;
+            }
+            case 6:
+                treeOther.insert(key, value);
+                flatOther.insert(key, value);
+                break;
+            case 7:
+                if (twister() % 50 == 0) {
+                    tree.merge(treeOther);
+                    flat.merge(flatOther);
+                }
+                break;
+        }
+        assert(tree.size() == flat.size());
+        assert(tree.count(key) == flat.count(key));
+        if (!tree.empty()) {
+            assert(tree.minValue() == flat.minValue());
+            assert(tree.maxValue() == flat.maxValue());
+            assert(tree.minKey() == flat.minKey());
+            assert(tree.maxKey() == flat.maxKey());
+        }
+        if (i % 1000 == 0) {
+            auto frozen = freeze(tree);
+            assert(frozen == flat);
+            auto it = tree.valueBegin();
+            for (auto p : flat.byValue()) {
+                assert(p.first == it.key() && p.second == it.value());
+                ++it;
+            }
+            auto jt = tree.keyBegin();
+            for (auto p : frozen.byKey()) {
+                assert(p.first == jt.key() && p.second == jt.value());
+                ++jt;
+            }
+        }
+    }
+    while (!tree.empty()) {
+        assert(tree.minValue() == flat.minValue());
+        tree.deleteMin();
+        flat.deleteMin();
+    }
+    assert(flat.empty());
+}
+
+int main() {
+    testExample();
+    testRanges();
+    testFreeze();
+    testAgainstTree<PriorityQueueKeyTieBreak>();
+    testAgainstTree<PriorityQueueFifoTieBreak>();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -1,8 +1,17 @@
+#include <algorithm>
 #include <iostream>
 #include <exception>
 #include <cassert>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <vector>
 
 #include "priorityqueue.hh"
+#include "arena.hh"
+#include "intern.hh"
+#include "mappedqueue.hh"
+#include "queuestats.hh"
 
 PriorityQueue<int, int> f(PriorityQueue<int, int> q)
 {
@@ -181,7 +190,7 @@ struct CopyThrower {
         if (p || THROW_NOW_THIS_IS_MADNESS)
             throw WeirdException("copy fail");
     }
-    CopyThrower(CopyThrower &&) noexcept {}
+    CopyThrower(CopyThrower &&other) noexcept : p(other.p) {}
 
     bool operator<(const CopyThrower&) const { return true; }
     bool operator==(const CopyThrower&) const { return true; }
@@ -191,8 +200,8 @@ struct CopyThrower {
 
 struct MoveThrower {
     MoveThrower(bool p = true) : p(p) { }
-    MoveThrower(const MoveThrower&) noexcept { }
-    MoveThrower(MoveThrower &&) {
+    MoveThrower(const MoveThrower &other) noexcept : p(other.p) { }
+    MoveThrower(MoveThrower &&other) : p(other.p) {
         if (p || THROW_NOW_THIS_IS_MADNESS)
             throw WeirdException("move fail");
     }
@@ -212,6 +221,17 @@ struct CompareThrower {
 
 
 
+struct ThrowingKey {
+    int key;
+    bool operator<(const ThrowingKey &other) const {
+        if (THROW_NOW_THIS_IS_MADNESS)
+            throw WeirdException("compare fail");
+        return key < other.key;
+    }
+    bool operator==(const ThrowingKey &other) const { return key == other.key; }
+};
+
+
 void testCompare() {
     PriorityQueue<int, CompareThrower> P;
 
@@ -472,7 +492,1051 @@ void testOutOfMemory1() {
     }
 }
 
+void testArena() {
+    using ArenaQueue = PriorityQueue<int, int, ArenaAllocator<std::pair<const int, int>>>;
+    PriorityQueueArena arena, other;
+    {
+        ArenaQueue P(arena), Q(arena), R(other);
+        for (int i = 0; i < 1000; i++) {
+            P.insert(i, 1000 - i);
+            R.insert(i, i);
+        }
+        assert(P.minKey() == 999);
+        assert(P.maxValue() == 1000);
+
+        ArenaQueue C(P);
+        assert(C == P);
+        assert(C.get_allocator() == P.get_allocator());
+
+        Q.insert(5000, -1);
+        P.merge(Q);
+        assert(Q.empty());
+        assert(P.size() == 1001);
+        assert(P.minKey() == 5000);
+
+        // rozne areny: elementy sa kopiowane, a nie przepinane
+        P.merge(R);
+        assert(R.empty());
+        assert(P.size() == 2001);
+        assert(P.minValue() == -1);
+        while (!P.empty()) {
+            P.deleteMin();
+        }
+        R = C;
+        assert(R == C);
+        assert(R.get_allocator() == C.get_allocator());
+    }
+    {
+        // tymczasowe bufory merge i kopiowania nie zajmują pamięci areny,
+        // więc powtarzane operacje jej nie rozrastają
+        ArenaQueue P(arena), Q(arena);
+        for (int i = 0; i < 5000; i++) {
+            P.insert(i, i);
+        }
+        std::size_t reserved = 0;
+        for (int round = 0; round < 50; round++) {
+            for (int i = 0; i < 5000; i++) {
+                Q.insert(i, -i);
+            }
+            P.merge(Q);
+            ArenaQueue C(P);
+            while (P.size() > 5000) {
+                P.deleteMin();
+            }
+            if (round == 0) {
+                reserved = arena.reserved();
+            }
+            assert(arena.reserved() == reserved);
+        }
+    }
+    arena.release();
+    other.release();
+}
+
+void testHandles() {
+    PriorityQueue<int, int> P;
+    using handle = PriorityQueue<int, int>::handle;
+    std::vector<handle> handles;
+    for (int i = 0; i < 100; i++) {
+        handles.push_back(P.insert(i, 1000 + i));
+    }
+    assert(handles[42].key() == 42);
+    assert(handles[42].value() == 1042);
+
+    // decrease-key
+    P.changeValue(handles[42], 5);
+    assert(P.minKey() == 42);
+    assert(P.minValue() == 5);
+    assert(handles[42].value() == 5);
+
+    // increase-key
+    P.changeValue(handles[42], 5000);
+    assert(P.maxKey() == 42);
+    assert(P.minKey() == 0);
+
+    P.erase(handles[0]);
+    assert(P.size() == 99);
+    assert(P.minKey() == 1);
+    P.erase(handles[42]);
+    assert(P.maxKey() == 99);
+
+    PriorityQueue<int, int> Q;
+    handle h = Q.insert(7, -1);
+    P.merge(Q);
+    assert(P.minKey() == 7);
+    P.changeValue(h, 10000);
+    assert(P.maxKey() == 7);
+
+    PriorityQueue<int, int> R;
+    R.insert(1, 1000 + 1);
+    for (int i = 2; i < 100; i++) {
+        if (i != 42)
+            R.insert(i, 1000 + i);
+    }
+    R.insert(7, 10000);
+    assert(P == R);
+}
+
+void testBulk() {
+    std::vector<std::pair<int, int>> sorted, shuffled;
+    for (int i = 0; i < 1000; i++) {
+        sorted.emplace_back(i, i / 2);
+        shuffled.emplace_back(i, (i * 7919) % 1000);
+    }
+    std::shuffle(shuffled.begin(), shuffled.end(), twister);
+
+    PriorityQueue<int, int> P(sorted.begin(), sorted.end()), Q;
+    for (auto &p : sorted) {
+        Q.insert(p.first, p.second);
+    }
+    assert(P == Q);
+    assert(P.minKey() == 0);
+    assert(P.maxKey() == 999);
+
+    PriorityQueue<int, int> R(shuffled.begin(), shuffled.end());
+    assert(R.size() == 1000);
+    assert(R.minKey() == 0);
+    assert(R.maxValue() == 999);
+
+    R.assign(sorted.begin(), sorted.end());
+    assert(R == P);
+
+    R.insert(shuffled.begin(), shuffled.end());
+    assert(R.size() == 2000);
+    for (auto &p : shuffled) {
+        Q.insert(p.first, p.second);
+    }
+    assert(R == Q);
+
+    PriorityQueue<ThrowingKey, int> S;
+    std::vector<std::pair<ThrowingKey, int>> keys;
+    for (int i = 0; i < 100; i++) {
+        keys.emplace_back(ThrowingKey{100 - i}, i);
+    }
+    S.insert(ThrowingKey{1000}, 1);
+    THROW_NOW_THIS_IS_MADNESS = true;
+    try {
+        S.assign(keys.begin(), keys.end());
+        assert(!"did not throw");
+    }
+    catch (WeirdException &) {
+    }
+    THROW_NOW_THIS_IS_MADNESS = false;
+    assert(S.size() == 1);
+    assert(S.minKey().key == 1000);
+}
+
+void testMerge() {
+    for (int small : {1, 10, 1000}) {
+        PriorityQueue<int, int> P, Q, expected;
+        for (int i = 0; i < 1000; i++) {
+            P.insert(i, (i * 31) % 1000);
+            expected.insert(i, (i * 31) % 1000);
+        }
+        PriorityQueue<int, int>::handle h;
+        for (int i = 0; i < small; i++) {
+            h = Q.insert(i, (i * 17) % 1000);
+            expected.insert(i, (i * 17) % 1000);
+        }
+        P.merge(Q);
+        assert(Q.empty());
+        assert(P == expected);
+        P.changeValue(h, -1);
+        assert(P.minKey() == small - 1);
+
+        // mniejsza kolejka po lewej stronie
+        PriorityQueue<int, int> R;
+        R.insert(5000, 5000);
+        R.merge(P);
+        assert(P.empty());
+        assert(R.size() == expected.size() + 1);
+        assert(R.maxKey() == 5000);
+        assert(R.minKey() == small - 1);
+    }
+}
+
+struct FailingOutput {
+    vector<pair<int, int>> *out;
+    size_t limit;
+    FailingOutput &operator*() { return *this; }
+    FailingOutput &operator++() { return *this; }
+    FailingOutput &operator=(pair<int, int> &&p) {
+        if (out->size() == limit) {
+            throw runtime_error("full");
+        }
+        out->push_back(p);
+        return *this;
+    }
+};
+
+// kopiowanie zgłasza wyjątek, gdy failCopies jest ustawione; przenoszenie
+// nie jest noexcept, więc kolejka musi kopiować
+bool failCopies = false;
+
+struct FragileCopy {
+    FragileCopy(int x = 0) : v(x) { }
+    FragileCopy(const FragileCopy &other) : v(other.v) {
+        if (failCopies)
+            throw runtime_error("copy fail");
+    }
+    FragileCopy &operator=(const FragileCopy &other) = default;
+    bool operator<(const FragileCopy &other) const { return v < other.v; }
+    bool operator==(const FragileCopy &other) const { return v == other.v; }
+    int v;
+};
+
+void testBatchPop() {
+    for (size_t n : {0, 1, 7, 300, 1000, 2000}) {
+        PriorityQueue<int, int> P, Q;
+        for (int i = 0; i < 1000; i++) {
+            P.insert(i, (i * 37) % 101);
+        }
+        Q = P;
+        vector<pair<int, int>> out;
+        P.popMin(n, back_inserter(out));
+        assert(out.size() == min<size_t>(n, 1000));
+        assert(P.size() == 1000 - out.size());
+        for (auto &p : out) {
+            assert(p.second == Q.minValue());
+            Q.deleteMin();
+        }
+        assert(P == Q);
+
+        out.clear();
+        P.popMax(5, back_inserter(out));
+        for (size_t i = 1; i < out.size(); i++) {
+            assert(!(out[i - 1].second < out[i].second));
+        }
+        for (auto &p : out) {
+            assert(p.second == Q.maxValue());
+            Q.deleteMax();
+        }
+        assert(P == Q);
+    }
+
+    for (size_t n : {10, 900}) {
+        PriorityQueue<int, int> P;
+        for (int i = 0; i < 1000; i++) {
+            P.insert(i, i);
+        }
+        vector<pair<int, int>> out;
+        try {
+            P.popMin(n, FailingOutput{&out, n / 2});
+            assert(false);
+        }
+        catch (const runtime_error &) {
+        }
+        assert(out.size() == n / 2);
+        assert(P.size() == 1000 - n / 2);
+        assert(P.minValue() == int(n / 2));
+        assert(P.minKey() == int(n / 2));
+        P.insert(-1, -1);
+        assert(P.minKey() == -1);
+    }
+
+    // klucz przenosi się bez wyjątków, a kopiowanie wartości zgłasza wyjątek:
+    // klucz nie może zostać przeniesiony z węzła
+    PriorityQueue<string, FragileCopy, allocator<pair<const string, FragileCopy>>,
+                  PriorityQueueHashLookup<>> P;
+    for (int i = 0; i < 100; i++) {
+        P.insert("key" + to_string(i), FragileCopy(i));
+    }
+    auto Q = P;
+    vector<pair<string, FragileCopy>> out;
+    failCopies = true;
+    try {
+        P.popMin(10, back_inserter(out));
+        assert(false);
+    }
+    catch (const runtime_error &) {
+    }
+    failCopies = false;
+    assert(out.empty() && P == Q);
+    assert(P.minKey() == "key0" && P.contains("key0") && P.count("key0") == 1);
+    P.popMin(10, back_inserter(out));
+    assert(out.size() == 10 && out[0].first == "key0" && !P.contains("key0"));
+}
+
+template<typename Queue>
+void testKeyLookup() {
+    Queue P;
+    assert(!P.contains(1));
+    assert(P.count(1) == 0);
+    assert(P.erase(1) == 0);
+    for (int i = 0; i < 1000; i++) {
+        P.insert(i % 100, i);
+    }
+    assert(P.contains(42));
+    assert(!P.contains(100));
+    assert(P.count(42) == 10);
+    P.changeValue(42, -5);
+    assert(P.minKey() == 42);
+    assert(P.count(42) == 10);
+    assert(P.erase(42) == 10);
+    assert(!P.contains(42));
+    assert(P.size() == 990);
+    assert(P.minValue() == 0);
+
+    Queue Q(P), R;
+    assert(Q.contains(7) && Q.count(7) == 10);
+    R.insert(500, 1);
+    R.merge(Q);
+    assert(Q.empty() && !Q.contains(7));
+    assert(R.contains(7) && R.contains(500));
+    for (int i = 0; i < 100; i++) {
+        R.erase(i);
+    }
+    assert(R.size() == 1);
+    R.changeValue(500, 2);
+    assert(R.minValue() == 2);
+    try {
+        R.changeValue(42, 1);
+        assert(false);
+    }
+    catch (const PriorityQueueNotFoundException &) {
+    }
+}
+
+template<typename Queue>
+void testSnapshot() {
+    Queue P;
+    auto h = P.insert(1, 10);
+    P.insert(2, 20);
+    auto snap = P.snapshot();
+    assert(P.snapshot() == snap);
+    assert(*snap == P);
+    assert(P.contains(1) && snap->contains(2));
+
+    // bez modyfikacji kolejki migawka ją tylko współdzieli
+    Queue copy(P);
+    assert(copy == *snap);
+
+    P.insert(3, 5);
+    P.changeValue(2, 1);
+    P.deleteMax();
+    assert(snap->size() == 2);
+    assert(snap->minKey() == 1 && snap->maxKey() == 2);
+    assert(snap->maxValue() == 20);
+    assert(P.size() == 2);
+    assert(P.minKey() == 2 && P.maxKey() == 3);
+
+    auto second = P.snapshot();
+    assert(second != snap);
+    P.deleteMin();
+    assert(second->size() == 2 && P.size() == 1);
+    snap.reset();
+    second.reset();
+
+    // gdy migawek już nie ma, kolejka odzyskuje węzły i uchwyty są znów ważne
+    Queue Q;
+    h = Q.insert(7, 70);
+    Q.insert(8, 80);
+    auto dropped = Q.snapshot();
+    dropped.reset();
+    Q.changeValue(h, 90);
+    assert(Q.maxKey() == 7);
+    Q.erase(h);
+    assert(Q.size() == 1 && Q.minKey() == 8);
+
+    auto last = Q.snapshot();
+    Q.merge(P);
+    assert(Q.size() == 2 && last->size() == 1);
+    Queue R(std::move(Q));
+    R.deleteMin();
+    R.deleteMin();
+    assert(R.empty() && last->minKey() == 8);
+
+    // uchwyt sprzed migawki jest przestawiany na kopię pary, a migawka zostaje nietknięta
+    Queue S;
+    auto first = S.insert(1, 10);
+    S.insert(2, 20);
+    auto held = S.snapshot();
+    first = S.changeValue(first, 30);
+    assert(first.value() == 30 && S.maxKey() == 1 && held->maxKey() == 2 && held->minValue() == 10);
+    auto other = S.snapshot();
+    S.erase(S.keyBegin().toHandle());
+    assert(S.size() == 1 && S.minKey() == 2);
+    assert(other->size() == 2 && other->maxValue() == 30 && held->size() == 2);
+}
+
+void testLayout() {
+    // zaczepy w obu drzewach to sześć wskaźników; priorytet dopełnia klucz
+    // do wyrównania wartości (dokładny rozmiar zależy od ABI)
+    if (sizeof(void *) == 8 && alignof(long long) == 8 && sizeof(int) == 4) {
+        assert((PriorityQueue<int, long long>::node_size == 6 * sizeof(void *) + 16));
+    }
+    assert((PriorityQueue<int, int>::node_size <= 6 * sizeof(void *) + 16));
+
+    PriorityQueue<int, double> P;
+    for (int i = 0; i < 1000; i++) {
+        P.insert(i, -i);
+    }
+    assert(P.minKey() == 999 && P.maxKey() == 0);
+    PriorityQueue<int, double> Q(P);
+    assert(P == Q);
+}
+
+void testIntern() {
+    PriorityQueueInternPool<string> pool;
+    const string statuses[] = {"waiting", "running", "done"};
+    {
+        PriorityQueue<int, Interned<string>> P, Q;
+        for (int i = 0; i < 300; i++) {
+            P.insert(i, pool.intern(statuses[i % 3]));
+            Q.insert(i, pool.intern(statuses[(i + 1) % 3]));
+        }
+        assert(pool.size() == 3);
+        assert(P.minValue().get() == "done" && P.maxValue().get() == "waiting");
+        assert(P.minValue().get() == Q.minValue().get());
+
+        P.changeValue(0, pool.intern("failed"));
+        assert(pool.size() == 4);
+        assert(P.minKey() == 2 && P.count(0) == 1);
+        PriorityQueue<int, Interned<string>> R(P);
+        assert(R == P && !(R < P));
+        P.merge(Q);
+        assert(P.size() == 600 && Q.empty());
+        assert(pool.purge() == 0);
+    }
+    assert(pool.size() == 4);
+    assert(pool.purge() == 4);
+    assert(pool.size() == 0);
+
+    PriorityQueue<Interned<string>, int, allocator<pair<const Interned<string>, int>>,
+        PriorityQueueHashLookup<>> S;
+    S.insert(pool.intern("a"), 1);
+    S.insert(pool.intern("b"), 2);
+    assert(S.contains(pool.intern("a")));
+    S.changeValue(pool.intern("a"), 3);
+    assert(S.maxKey().get() == "a");
+}
+
+void testFile() {
+    const string path = "test2_queue.bin";
+    PriorityQueue<int, double> P;
+    for (int i = 0; i < 1000; i++) {
+        P.insert(i % 300, (i * 7919) % 1009 / 10.0);
+    }
+    P.save(path);
+    auto Q = PriorityQueue<int, double>::load(path);
+    assert(P == Q);
+    assert(Q.minKey() == P.minKey() && Q.maxValue() == P.maxValue());
+    Q.changeValue(5, -1);
+    assert(Q.minKey() == 5);
+    {
+        MappedPriorityQueue<int, double> M(path);
+        assert(M.size() == 1000);
+        assert(M.minValue() == P.minValue() && M.minKey() == P.minKey());
+        assert(M.maxValue() == P.maxValue() && M.maxKey() == P.maxKey());
+        assert(M.count(7) == P.count(7) && M.contains(299) && !M.contains(300));
+    }
+
+    PriorityQueue<int, double>().save(path);
+    assert((PriorityQueue<int, double>::load(path).empty()));
+    assert((MappedPriorityQueue<int, double>(path).empty()));
+
+    bool thrown = false;
+    try {
+        PriorityQueue<int, int>::load(path);
+    }
+    catch (const PriorityQueueFileException &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // sam nagłówek, krótszy od początku rekordów, i nagłówek z licznikiem,
+    // którego iloczyny przepełniają się
+    PriorityQueueFileHeader header = PriorityQueueFileHeader::describe<int, double,
+        PriorityQueueFileRecord<int, double>>(1000);
+    for (std::uint64_t count : {std::uint64_t(1000), std::uint64_t(1) << 61}) {
+        header.count = count;
+        FILE *file = fopen(path.c_str(), "wb");
+        assert(file && fwrite(&header, sizeof(header), 1, file) == 1);
+        fclose(file);
+        int rejected = 0;
+        try {
+            PriorityQueue<int, double>::load(path);
+        }
+        catch (const PriorityQueueFileException &) {
+            rejected++;
+        }
+        try {
+            MappedPriorityQueue<int, double> M(path);
+        }
+        catch (const PriorityQueueFileException &) {
+            rejected++;
+        }
+        assert(rejected == 2);
+    }
+
+    remove(path.c_str());
+    thrown = false;
+    try {
+        MappedPriorityQueue<int, double> M(path);
+    }
+    catch (const PriorityQueueFileException &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void testIterators() {
+    PriorityQueue<int, int> P;
+    const PriorityQueue<int, int> &C = P;
+    assert(C.valueBegin() == C.valueEnd());
+    assert(C.byKey().empty());
+    for (int i = 0; i < 100; i++) {
+        P.insert(i, (i * 37) % 100);
+    }
+
+    int count = 0;
+    int last = -1;
+    for (auto p : C.byValue()) {
+        assert(p.second > last);
+        assert(p.second == (p.first * 37) % 100);
+        last = p.second;
+        count++;
+    }
+    assert(count == 100);
+
+    count = 0;
+    for (auto it = C.keyBegin(); it != C.keyEnd(); ++it) {
+        assert(it->first == count && it.key() == count);
+        count++;
+    }
+
+    // top 10 wartości od największej
+    auto rit = C.valueRBegin();
+    for (int v = 99; v >= 90; v--, ++rit) {
+        assert((*rit).second == v);
+    }
+    auto end = C.valueEnd();
+    --end;
+    assert(end.value() == 99 && end.key() == C.maxKey());
+
+    auto range = C.valueRange(10, 20);
+    count = 0;
+    for (auto it = range.begin(); it != range.end(); it++) {
+        assert(it.value() == 10 + count);
+        count++;
+    }
+    assert(count == 10);
+    assert(C.valueRange(20, 10).empty());
+    assert(C.valueRange(100, 200).empty());
+
+    auto keys = C.keyRange(95, 1000);
+    count = 0;
+    for (auto p : keys) {
+        assert(p.first >= 95);
+        count++;
+    }
+    assert(count == 5);
+
+    P.changeValue(C.keyRange(50, 51).begin().toHandle(), -1);
+    assert(P.minKey() == 50);
+}
+
+template<typename Queue>
+void testSplit() {
+    Queue P;
+    for (int i = 0; i < 100; i++) {
+        P.insert(i, (i * 37) % 100);
+    }
+    Queue R = P.splitByValue(90);
+    assert(P.size() == 90 && R.size() == 10);
+    assert(P.maxValue() == 89 && R.minValue() == 90 && R.maxValue() == 99);
+    for (auto p : R.byKey()) {
+        assert(p.second >= 90 && !P.contains(p.first));
+    }
+    assert(R.contains(R.minKey()) && R.count(R.maxKey()) == 1);
+
+    // dużo przenoszonych par: drzewo kluczy jest budowane od nowa
+    Queue S = P.splitByKey(10);
+    assert(P.size() == 9 && S.size() == 81);
+    assert(P.minKey() == 0 && P.byKey().begin().key() == 0);
+    int last = -1;
+    for (auto p : S.byValue()) {
+        assert(p.first >= 10 && p.second > last);
+        last = p.second;
+    }
+
+    P.merge(S);
+    P.merge(R);
+    assert(P.size() == 100);
+    Queue empty = P.splitByValue(1000);
+    assert(empty.empty() && P.size() == 100);
+    Queue all = P.splitByKey(-1);
+    assert(P.empty() && all.size() == 100);
+    all.insert(-5, -5);
+    assert(all.minKey() == -5 && all.contains(99));
+
+    auto snap = all.snapshot();
+    Queue top = all.splitByValue(50);
+    assert(snap->size() == 101 && all.size() == 51 && top.size() == 50);
+}
+
+void testContentHash() {
+    PriorityQueue<int, int> P, Q;
+    assert(P.contentHash() == Q.contentHash());
+    for (int i = 0; i < 50; i++) {
+        P.insert(i, i * i);
+        Q.insert(49 - i, (49 - i) * (49 - i));
+    }
+    assert(P.contentHash() == Q.contentHash() && P == Q);
+    Q.changeValue(7, 0);
+    assert(P.contentHash() != Q.contentHash() && P != Q);
+    assert(Q < P && !(P < Q));
+    Q.changeValue(7, 49);
+    assert(P.contentHash() == Q.contentHash() && P == Q);
+
+    // ta sama para dwa razy to co innego niż para raz
+    P.insert(3, 9);
+    Q.insert(3, 9);
+    Q.deleteMax();
+    assert(P.size() != Q.size() || P.contentHash() != Q.contentHash());
+
+    std::vector<std::pair<int, int>> popped;
+    P.popMin(10, std::back_inserter(popped));
+    PriorityQueue<int, int> R(popped.begin(), popped.end());
+    R.merge(P);
+    assert(R.contentHash() == (PriorityQueue<int, int>(R).contentHash()));
+    auto upper = R.splitByKey(25);
+    R.merge(upper);
+    assert(R.size() == 51);
+
+    auto snap = R.snapshot();
+    assert(*snap == R && !(*snap < R));
+    R.deleteMin();
+    assert(snap->contentHash() != R.contentHash());
+
+    PriorityQueue<std::string, std::string> S, T;
+    S.insert("a", "x");
+    S.insert("b", "y");
+    T.insert("b", "y");
+    T.insert("a", "x");
+    assert(S.contentHash() == T.contentHash() && S == T);
+}
+
+/*Polityka z własnym zaczepem, np. eksportem do systemu metryk */
+struct MissReporter : public PriorityQueueCountingStats {
+    int misses = 0;
+
+    void record(PriorityQueueEvent event, std::size_t count, std::size_t size, int started) noexcept {
+        PriorityQueueCountingStats::record(event, count, size, started);
+        if (event == PriorityQueueEvent::changeMiss) {
+            misses++;
+        }
+    }
+};
+
+void testStats() {
+    using Counted = PriorityQueue<int, int, allocator<pair<const int, int>>,
+                                  PriorityQueueTreeLookup, PriorityQueueCountingStats>;
+    Counted P;
+    for (int i = 0; i < 10; i++) {
+        P.insert(i, i);
+    }
+    P.deleteMin();
+    P.deleteMax();
+    P.changeValue(5, 50);
+    try {
+        P.changeValue(100, 1);
+        assert(false);
+    }
+    catch (const PriorityQueueNotFoundException &) {
+    }
+    std::vector<std::pair<int, int>> popped;
+    P.popMin(3, std::back_inserter(popped));
+    Counted Q;
+    Q.insert(20, 20);
+    P.merge(Q);
+    Counted R = P.splitByKey(20);
+
+    PriorityQueueStats stats = P.stats();
+    assert(stats.count(PriorityQueueEvent::insert) == 10);
+    assert(stats.count(PriorityQueueEvent::deleteMin) == 4);
+    assert(stats.count(PriorityQueueEvent::deleteMax) == 1);
+    assert(stats.count(PriorityQueueEvent::changeHit) == 1);
+    assert(stats.count(PriorityQueueEvent::changeMiss) == 1);
+    assert(stats.count(PriorityQueueEvent::merge) == 1);
+    assert(stats.count(PriorityQueueEvent::split) == 1);
+    // changeValue przepina istniejący węzeł
+    assert(stats.count(PriorityQueueEvent::allocate) == 10);
+    assert(stats.peakSize == 10 && stats.size == 5);
+    assert(stats.bytes == 5 * Counted::node_size && stats.peakBytes == 10 * Counted::node_size);
+    assert(R.stats().count(PriorityQueueEvent::insert) == 0 && R.size() == 1);
+
+    // statystyki należą do obiektu, a nie do zawartości
+    Counted copy(P);
+    assert(copy.stats().count(PriorityQueueEvent::allocate) == 5);
+    P.swap(copy);
+    assert(P.stats().count(PriorityQueueEvent::insert) == 10);
+
+    PriorityQueue<int, int, allocator<pair<const int, int>>, PriorityQueueTreeLookup, PriorityQueueTimedStats> T;
+    T.insert(1, 1);
+    T.insert(2, 2);
+    std::uint64_t timed = 0;
+    for (std::uint64_t c : T.stats().latency[static_cast<unsigned>(PriorityQueueEvent::insert)]) {
+        timed += c;
+    }
+    assert(timed == 2);
+
+    PriorityQueue<int, int, allocator<pair<const int, int>>, PriorityQueueHashLookup<>, MissReporter> H;
+    try {
+        H.changeValue(1, 1);
+    }
+    catch (const PriorityQueueNotFoundException &) {
+    }
+    assert(H.statsPolicy().misses == 1);
+
+    PriorityQueue<int, int> plain;
+    plain.insert(1, 1);
+    assert(plain.stats().count(PriorityQueueEvent::insert) == 0 && plain.stats().size == 1);
+}
+
+void testTry() {
+    PriorityQueue<int, std::string> P;
+    assert(!P.tryMinValue() && !P.tryMaxValue() && !P.tryMinKey() && !P.tryMaxKey());
+    assert(!P.tryPopMin() && !P.tryPopMax());
+    assert(!P.tryChangeValue(1, "x"));
+
+    P.insert(1, "b");
+    P.insert(2, "a");
+    P.insert(3, "c");
+    assert(*P.tryMinValue() == "a" && *P.tryMinKey() == 2);
+    assert(*P.tryMaxValue() == "c" && *P.tryMaxKey() == 3);
+    assert(P.tryChangeValue(3, std::string("0")) && *P.tryMinKey() == 3);
+    assert(!P.tryChangeValue(4, "d") && P.size() == 3);
+
+    auto top = P.tryPopMin();
+    assert(top && top->first == 3 && top->second == "0");
+    top = P.tryPopMax();
+    assert(top.value().first == 1 && top.value().second == "b");
+    assert(P.size() == 1 && P.minKey() == 2 && P.contains(2));
+
+    // chybienie przy istniejącej migawce nie kopiuje kolejki
+    using Counted = PriorityQueue<int, int, allocator<pair<const int, int>>,
+                                  PriorityQueueHashLookup<>, PriorityQueueCountingStats>;
+    Counted Q;
+    Q.insert(1, 1);
+    Q.insert(2, 2);
+    auto snap = Q.snapshot();
+    assert(!Q.tryChangeValue(3, 3));
+    assert(Q.erase(3) == 0);
+    assert(Q.stats().count(PriorityQueueEvent::allocate) == 2);
+    assert(Q.tryChangeValue(2, 0) && *Q.tryMinKey() == 2 && snap->minKey() == 1);
+    assert(Q.tryPopMin()->first == 2 && Q.size() == 1 && !Q.contains(2) && Q.contains(1));
+    assert(snap->size() == 2);
+
+    // wyjątek przy kopiowaniu wartości nie może zostawić w węźle
+    // przeniesionego klucza
+    PriorityQueue<string, FragileCopy, allocator<pair<const string, FragileCopy>>,
+                  PriorityQueueHashLookup<>> R;
+    R.insert("b", FragileCopy(2));
+    R.insert("a", FragileCopy(1));
+    failCopies = true;
+    for (bool fromMin : {true, false}) {
+        try {
+            fromMin ? R.tryPopMin() : R.tryPopMax();
+            assert(false);
+        }
+        catch (const runtime_error &) {
+        }
+    }
+    failCopies = false;
+    assert(R.size() == 2 && R.minKey() == "a" && R.maxKey() == "b");
+    assert(R.contains("a") && R.contains("b"));
+    assert(R.tryPopMin()->first == "a" && R.tryPopMax()->first == "b" && R.empty());
+}
+
+struct ThrowingMove {
+    ThrowingMove(int x = 0) : v(x) { }
+    ThrowingMove &operator=(ThrowingMove &&other) noexcept(false) { v = other.v; return *this; }
+    ThrowingMove(const ThrowingMove &) = default;
+    ThrowingMove &operator=(const ThrowingMove &) = default;
+    bool operator<(const ThrowingMove &other) const { return v < other.v; }
+    bool operator==(const ThrowingMove &other) const { return v == other.v; }
+    int v;
+};
+
+void testCapacity() {
+    using Counted = PriorityQueue<int, int, allocator<pair<const int, int>>,
+                                  PriorityQueueHashLookup<>, PriorityQueueCountingStats>;
+    Counted P;
+    assert(P.capacity() == std::numeric_limits<size_t>::max());
+    P.setCapacity(3);
+    for (int i = 0; i < 100; i++) {
+        P.insert(i, (i * 37) % 101);
+    }
+    // 3 najmniejsze wartości (i * 37) % 101 dla i < 100 to 0, 1, 2 z kluczami 0, 71, 41
+    assert(P.size() == 3 && P.minValue() == 0 && P.maxValue() == 2);
+    assert(P.stats().count(PriorityQueueEvent::allocate) == 3);
+    assert(P.contains(0) && P.contains(71) && P.contains(41) && !P.contains(11));
+    assert(P.count(71) == 1 && P.maxKey() == 41);
+
+    // para nie mniejsza od największej jest odrzucana
+    assert(P.insert(50, 2) == Counted::handle() && P.insert(6, 50) == Counted::handle());
+    auto h = P.insert(7, 1);
+    assert(h.key() == 7 && P.size() == 3 && P.maxKey() == 71 && !P.contains(41));
+
+    Counted Q(P);
+    assert(Q == P && Q.capacity() == 3);
+    auto snap = P.snapshot();
+    P.insert(8, -1);
+    assert(P.minKey() == 8 && P.maxKey() == 7 && snap->maxKey() == 71 && snap->size() == 3);
+
+    vector<pair<int, int>> more = {{1, -5}, {2, 10}, {3, -3}};
+    P.insert(more.begin(), more.end());
+    assert(P.size() == 3 && P.minKey() == 1 && P.maxKey() == 8);
+    P.merge(Q);
+    assert(Q.empty() && P.size() == 3 && P.maxKey() == 8);
+    P.assign(more.begin(), more.end());
+    assert(P.size() == 3 && P.maxKey() == 2);
+
+    // druga strona jest większa, więc jest scalana jako kolejka docelowa
+    Counted B;
+    B.setCapacity(10);
+    Counted large;
+    vector<pair<int, int>> many;
+    for (int i = 0; i < 1000; i++) {
+        large.insert(i, i);
+        many.emplace_back(i, -i);
+    }
+    B.insert(5000, -1);
+    B.merge(large);
+    assert(large.empty() && large.capacity() == std::numeric_limits<size_t>::max());
+    assert(B.capacity() == 10 && B.size() == 10 && B.minKey() == 5000 && B.maxValue() == 8);
+    B.insert(many.begin(), many.end());
+    assert(B.capacity() == 10 && B.size() == 10 && B.minValue() == -999 && B.maxValue() == -990);
+
+    P.setCapacity(1);
+    assert(P.size() == 1 && P.minKey() == 1);
+    P.emplace(std::piecewise_construct, std::forward_as_tuple(4), std::forward_as_tuple(-7));
+    assert(P.size() == 1 && P.minKey() == 4);
+    P.setCapacity(0);
+    assert(P.empty() && P.insert(1, 1) == Counted::handle() && P.empty());
+
+    // bez przenoszenia noexcept para jest wstawiana, a potem wypierana
+    PriorityQueue<int, ThrowingMove> R;
+    R.setCapacity(2);
+    R.insert(1, ThrowingMove(3));
+    R.insert(2, ThrowingMove(1));
+    R.insert(3, ThrowingMove(2));
+    assert((R.size() == 2 && R.maxKey() == 3 && R.insert(4, ThrowingMove(5)) == PriorityQueue<int, ThrowingMove>::handle()));
+}
+
+void testChangeInPlace() {
+    using Counted = PriorityQueue<int, std::string, allocator<pair<const int, std::string>>,
+                                  PriorityQueueTreeLookup, PriorityQueueCountingStats>;
+    Counted P;
+    auto h = P.insert(1, "m");
+    P.insert(2, "c");
+    P.insert(2, "x");
+    P.insert(3, "q");
+    P.changeValue(1, "a");
+    P.changeValue(2, std::string("z"));
+    assert(P.stats().count(PriorityQueueEvent::allocate) == 4);
+    assert(h.value() == "a" && P.minKey() == 1 && P.maxKey() == 2 && P.count(2) == 2);
+    auto it = P.keyBegin();
+    assert(it.value() == "a" && (++it).value() == "x" && (++it).value() == "z" && (++it).value() == "q");
+
+    // bez przenoszenia noexcept para trafia do nowego węzła
+    PriorityQueue<int, ThrowingMove> R;
+    R.insert(1, ThrowingMove(3));
+    R.insert(2, ThrowingMove(1));
+    R.changeValue(1, ThrowingMove(0));
+    assert(R.minKey() == 1 && R.maxKey() == 2);
+}
+
+template<typename Q>
+std::vector<int> popKeys(Q &P) {
+    std::vector<int> keys;
+    while (!P.empty()) {
+        keys.push_back(P.minKey());
+        P.deleteMin();
+    }
+    return keys;
+}
+
+template<typename Lookup>
+void testFifo() {
+    using Q = PriorityQueue<int, int, allocator<pair<const int, int>>, Lookup,
+                            PriorityQueueNoStats, PriorityQueueFifoTieBreak>;
+    Q P;
+    P.insert(5, 1);
+    P.insert(3, 1);
+    P.insert(4, 1);
+    P.insert(1, 2);
+    assert(P.minKey() == 5 && P.maxKey() == 1);
+    assert((popKeys(P) == std::vector<int>{5, 3, 4, 1}));
+
+    // changeValue zmienia najwcześniej wstawioną z równych par i ustawia ją na końcu
+    auto h1 = P.insert(7, 5);
+    auto h2 = P.insert(7, 5);
+    P.insert(2, 9);
+    P.changeValue(7, 9);
+    assert(h1.value() == 9 && h2.value() == 5);
+    assert((popKeys(P) == std::vector<int>{7, 2, 7}));
+
+    // pary przeniesione przez merge i wstawienie zakresu idą za parami kolejki
+    for (int split : {0, 50, 100}) {
+        Q A, B;
+        A.insert(10, 0);
+        for (int i = 99; i >= 0; i--) {
+            (i >= split ? A : B).insert(i, 0);
+        }
+        B.insert(200, 0);
+        A.merge(B);
+        std::vector<int> expected = {10};
+        for (int i = 99; i >= 0; i--) {
+            expected.push_back(i);
+        }
+        expected.push_back(200);
+        std::vector<pair<int, int>> more = {{50, 0}, {-1, 0}};
+        A.insert(more.begin(), more.end());
+        expected.push_back(50);
+        expected.push_back(-1);
+        Q C(A);
+        assert(C == A);
+        const string path = "test2_fifo.bin";
+        A.save(path);
+        Q D = Q::load(path);
+        std::remove(path.c_str());
+        assert(popKeys(A) == expected && popKeys(C) == expected && popKeys(D) == expected);
+    }
+
+    // zakres zachowuje swoją kolejność, także przy odrzucaniu w pełnej kolejce
+    std::vector<pair<int, int>> pairs = {{3, 0}, {1, 0}, {2, 0}, {0, 1}};
+    Q R(pairs.begin(), pairs.end());
+    R.setCapacity(3);
+    assert(R.insert(9, 0) == typename Q::handle() && R.size() == 3);
+    assert((popKeys(R) == std::vector<int>{3, 1, 2}));
+}
+
+template<typename Q>
+void testKeyGroups() {
+    Q P;
+    for (int i = 0; i < 30; i++) {
+        P.insert(i % 3, 100 - i);
+    }
+    P.insert(5, 50);
+    auto group = P.equalRangeByKey(1);
+    int count = 0, last = -1;
+    for (auto p : group) {
+        assert(p.first == 1 && last < p.second);
+        last = p.second;
+        count++;
+    }
+    assert(count == 10 && P.equalRangeByKey(4).empty());
+
+    auto snap = P.snapshot();
+    assert(P.changeAllValues(1, 60) == 10 && P.changeAllValues(4, 0) == 0);
+    assert(snap->count(1) == 10 && snap->equalRangeByKey(1).begin().value() == 72);
+    assert(P.size() == 31 && P.count(1) == 10);
+    for (auto p : P.equalRangeByKey(1)) {
+        assert(p.second == 60);
+    }
+    // pary o kluczu 1 leżą w porządku wartości razem, między 50 a 71
+    std::vector<std::pair<int, int>> byValue;
+    for (auto p : P.byValue()) {
+        byValue.emplace_back(p.first, p.second);
+    }
+    auto first = std::find(byValue.begin(), byValue.end(), std::make_pair(1, 60));
+    assert(first != byValue.end() && (first - 1)->second == 50 && (first + 10)->second == 71);
+    assert(std::is_sorted(byValue.begin(), byValue.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+        return a.second < b.second || (a.second == b.second && a.first < b.first);
+    }));
+
+    P.changeAllValues(2, 0);
+    assert(P.minKey() == 2 && P.minValue() == 0 && P.erase(2) == 10 && P.minValue() == 50);
+
+    PriorityQueue<int, std::string> S;
+    S.insert(1, "b");
+    S.insert(1, "a");
+    S.insert(0, "c");
+    assert(S.changeAllValues(1, "z") == 2 && S.maxKey() == 1 && S.minValue() == "c");
+}
+
+struct CountingValue {
+    static int copies;
+    CountingValue(int value = 0) : v(value) { }
+    CountingValue(const CountingValue &other) : v(other.v) { copies++; }
+    CountingValue(CountingValue &&other) noexcept : v(other.v) { }
+    CountingValue &operator=(const CountingValue &other) { v = other.v; copies++; return *this; }
+    CountingValue &operator=(CountingValue &&other) noexcept { v = other.v; return *this; }
+    bool operator<(const CountingValue &other) const { return v < other.v; }
+    bool operator==(const CountingValue &other) const { return v == other.v; }
+    int v;
+};
+int CountingValue::copies = 0;
+
+void testMoves() {
+    PriorityQueue<std::string, CountingValue> P;
+    CountingValue::copies = 0;
+    P.insert(std::string("a"), CountingValue(3));
+    std::string key = "b";
+    P.insert(key, CountingValue(2));
+    P.emplace(std::piecewise_construct, std::forward_as_tuple(3, 'c'), std::forward_as_tuple(1));
+    assert(CountingValue::copies == 0);
+    assert(P.minKey() == "ccc");
+
+    P.changeValue("ccc", CountingValue(10));
+    assert(CountingValue::copies == 0);
+    assert(P.maxKey() == "ccc");
+    assert(P.minKey() == "b");
+
+    CountingValue four(4);
+    P.insert("d", four);
+    assert(CountingValue::copies == 1);
+    assert(P.size() == 4);
+}
+
 int main() {
+    testArena();
+    testMoves();
+    testHandles();
+    testBulk();
+    testMerge();
+    testBatchPop();
+    testKeyLookup<PriorityQueue<int, int>>();
+    testKeyLookup<PriorityQueue<int, int, allocator<pair<const int, int>>, PriorityQueueHashLookup<>>>();
+    testSnapshot<PriorityQueue<int, int>>();
+    testSnapshot<PriorityQueue<int, int, allocator<pair<const int, int>>, PriorityQueueHashLookup<>>>();
+    testLayout();
+    testIntern();
+    testFile();
+    testIterators();
+    testContentHash();
+    testStats();
+    testTry();
+    testCapacity();
+    testChangeInPlace();
+    testFifo<PriorityQueueTreeLookup>();
+    testFifo<PriorityQueueHashLookup<>>();
+    testKeyGroups<PriorityQueue<int, int>>();
+    testKeyGroups<PriorityQueue<int, int, allocator<pair<const int, int>>, PriorityQueueHashLookup<>>>();
+    testSplit<PriorityQueue<int, int>>();
+    testSplit<PriorityQueue<int, int, allocator<pair<const int, int>>, PriorityQueueHashLookup<>>>();
     testInt();
     testCopy();
     testCompare();
@@ -480,7 +1544,6 @@ int main() {
     testWeirdThings();
     testOutOfMemory1();
 
-    //testMove(); test nie ma chyba sensu skoro nie przenosimy wartosci do Årodka, a przenoszenie
-    // caÅej kolejki nie przenosi poszczegÃ³lnych elementÃ³w
+    testMove();
 }
 
@@ -0,0 +1,163 @@
+#include <iostream>
+#include <exception>
+#include <cassert>
+#include <random>
+#include <string>
+
+#include "priorityqueue.hh"
+#include "heapqueue.hh"
+
+using Heap = HeapPriorityQueue<int, int>;
+
+Heap f(Heap q)
+{
+    return q;
+}
+
+void testExample() {
+    Heap P = f(Heap());
+    assert(P.empty());
+
+    P.insert(1, 42);
+    P.insert(2, 13);
+
+    assert(P.size() == 2);
+    assert(P.maxKey() == 1);
+    assert(P.maxValue() == 42);
+    assert(P.minKey() == 2);
+    assert(P.minValue() == 13);
+
+    Heap Q(f(P));
+
+    Q.deleteMax();
+    Q.deleteMin();
+    Q.deleteMin();
+
+    assert(Q.empty());
+
+    Heap R(Q);
+
+    R.insert(1, 100);
+    R.insert(2, 100);
+    R.insert(3, 300);
+
+    Heap S;
+    S = R;
+
+    try {
+        S.changeValue(4, 400);
+        assert(!"did not throw");
+    }
+    catch (const PriorityQueueNotFoundException &) {
+    }
+
+    S.changeValue(2, 200);
+    assert(S.minValue() == 100);
+    assert(S.minKey() == 1);
+
+    try {
+        while (true) {
+            S.minValue();
+            S.deleteMin();
+        }
+    }
+    catch (const PriorityQueueEmptyException &) {
+    }
+
+    Heap T;
+    T.insert(1, 1);
+    T.insert(2, 4);
+    S.insert(3, 9);
+    S.insert(4, 16);
+    S.merge(T);
+    assert(S.size() == 4);
+    assert(S.minValue() == 1);
+    assert(S.maxValue() == 16);
+    assert(T.empty());
+
+    S = R;
+    swap(R, T);
+    assert(T == S);
+    assert(T != R);
+    assert(R < T);
+
+    R = std::move(S);
+    assert(T == R);
+}
+
+// HeapPriorityQueue ma dawać te same wyniki co PriorityQueue; klucze są
+// unikalne, żeby changeValue nie miało wyboru pary
+void testAgainstTree() {
+    std::mt19937 twister(42);
+    PriorityQueue<int, std::string> tree, treeOther;
+    HeapPriorityQueue<int, std::string> heap, heapOther;
+    for (int i = 0; i < 200000; i++) {
+        int key = twister() % 4 == 0 ? twister() % (i + 1) : i;
+        std::string value = std::to_string(twister() % 1000);
+        switch (twister() % 8) {
+            case 0:
+            case 1:
+            case 2:
+                key = i;
+                tree.insert(key, value);
+                heap.insert(key, value);
+                break;
+            case 3:
+                tree.deleteMin();
+                heap.deleteMin();
+                break;
+            case 4:
+                tree.deleteMax();
+                heap.deleteMax();
+                break;
+            case 5: {
+                bool treeFound = true, heapFound = true;
+                try {
+                    tree.changeValue(key, value);
+                }
+                catch (PriorityQueueNotFoundException &) {
+                    treeFound = false;
+                }
+                try {
+                    heap.changeValue(key, value);
+                }
+                catch (PriorityQueueNotFoundException &) {
+                    heapFound = false;
+                }
+                assert(treeFound == heapFound);
+                break;
+            }
+            case 6:
+                key = i;
+                treeOther.insert(key, value);
+                heapOther.insert(key, value);
+                break;
+            case 7:
+                if (twister() % 50 == 0) {
+                    tree.merge(treeOther);
+                    heap.merge(heapOther);
+                }
+                break;
+        }
+        assert(tree.size() == heap.size());
+        if (!tree.empty()) {
+            assert(tree.minValue() == heap.minValue());
+            assert(tree.maxValue() == heap.maxValue());
+            assert(tree.minKey() == heap.minKey());
+            assert(tree.maxKey() == heap.maxKey());
+        }
+    }
+    while (!tree.empty()) {
+        assert(tree.minValue() == heap.minValue());
+        tree.deleteMin();
+        heap.deleteMin();
+    }
+    assert(heap.empty());
+}
+
+int main() {
+    testExample();
+    testAgainstTree();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
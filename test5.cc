@@ -0,0 +1,111 @@
+#include <iostream>
+#include <exception>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+#include "concurrentqueue.hh"
+
+using Queue = ConcurrentPriorityQueue<int, int, 8>;
+
+void testSequential() {
+    Queue P;
+    assert(P.empty());
+    assert(!P.tryDeleteMin());
+    try {
+        P.minValue();
+        assert(false);
+    }
+    catch (const PriorityQueueEmptyException &) {
+    }
+
+    for (int i = 0; i < 100; i++) {
+        P.insert(i, (i * 37) % 101);
+    }
+    assert(P.size() == 100);
+    assert(P.minValue() == 0);
+    assert(P.minKey() == 0);
+    assert(P.maxValue() == 100);
+    P.changeValue(5, -1);
+    assert(P.minKey() == 5);
+    try {
+        P.changeValue(1000, 1);
+        assert(false);
+    }
+    catch (const PriorityQueueNotFoundException &) {
+    }
+    assert(!P.tryChangeValue(1000, 1));
+    assert(P.tryChangeValue(6, -2) && P.minKey() == 6);
+    P.changeValue(6, (6 * 37) % 101);
+
+    auto top = P.tryDeleteMin();
+    assert(top && top->first == 5 && top->second == -1);
+    top = P.tryDeleteMax();
+    assert(top && top->second == 100);
+    P.deleteMin();
+    assert(P.size() == 97);
+
+    Queue Q;
+    Q.insert(-7, -7);
+    P.merge(Q);
+    assert(Q.empty());
+    assert(P.minKey() == -7);
+    P.swap(Q);
+    assert(P.empty() && Q.size() == 98);
+
+    for (int last = -100; !Q.empty(); ) {
+        int value = Q.tryDeleteMin()->second;
+        assert(last <= value);
+        last = value;
+    }
+}
+
+void testThreads(bool relaxed) {
+    const int threads = 8;
+    const int perThread = 5000;
+    Queue P(relaxed);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&P, t]() {
+            for (int i = 0; i < perThread; i++) {
+                P.insert(t * perThread + i, i);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    assert(P.size() == threads * perThread);
+
+    std::vector<std::vector<int>> taken(threads);
+    workers.clear();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&P, &taken, t]() {
+            while (auto p = P.tryDeleteMin()) {
+                taken[t].push_back(p->first);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    assert(P.empty());
+
+    std::vector<bool> seen(threads * perThread, false);
+    for (auto &keys : taken) {
+        for (int key : keys) {
+            assert(!seen[key]);
+            seen[key] = true;
+        }
+    }
+    for (bool s : seen) {
+        assert(s);
+    }
+}
+
+int main() {
+    testSequential();
+    testThreads(false);
+    testThreads(true);
+    std::cout << "ALL OK!" << std::endl;
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <exception>
+#include <cassert>
+#include <random>
+#include <vector>
+
+#include "deferredqueue.hh"
+
+using Queue = DeferredPriorityQueue<int, int>;
+
+void testBurst() {
+    Queue P;
+    assert(P.empty());
+    assert(!P.tryPopMin());
+    try {
+        P.minValue();
+        assert(false);
+    }
+    catch (const PriorityQueueEmptyException &) {
+    }
+
+    for (int i = 0; i < 100; i++) {
+        P.insert(i, i);
+    }
+    // seria zmian tych samych kluczy nie porządkuje bufora
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < 100; i++) {
+            P.changeValue(i, (i * 37 + round) % 1000);
+        }
+    }
+    assert(P.pending() == 100 && P.size() == 100);
+    assert(P.count(5) == 1 && !P.contains(100));
+    assert(P.minValue() == 6 && P.minKey() == 81);
+    assert(P.pending() == 0);
+
+    // zmiany par już uporządkowanych też czekają na scalenie
+    P.changeValue(50, -1);
+    P.changeValue(50, -2);
+    assert(P.erase(60) == 1 && P.erase(60) == 0);
+    assert(P.size() == 99 && !P.contains(60));
+    assert(!P.tryChangeValue(60, 1));
+    try {
+        P.changeValue(1000, 1);
+        assert(false);
+    }
+    catch (const PriorityQueueNotFoundException &) {
+    }
+    P.insert(60, -3);
+    assert(P.minKey() == 60 && P.size() == 100);
+    P.deleteMin();
+    assert(P.minKey() == 50 && P.minValue() == -2);
+
+    // klucze z wieloma parami
+    P.insert(7, 500);
+    P.insert(7, 400);
+    assert(P.count(7) == 3);
+    P.changeValue(7, -5);
+    assert(P.minKey() == 7 && P.minValue() == -5 && P.count(7) == 3);
+    assert(P.erase(7) == 3 && P.size() == 98);
+    assert(P.queue().size() == 98);
+}
+
+void testRandom() {
+    std::mt19937 engine(7);
+    Queue P;
+    PriorityQueue<int, int> R;
+    for (int i = 0; i < 20000; i++) {
+        int key = engine() % 200;
+        int value = engine() % 1000;
+        switch (engine() % 8) {
+            case 0:
+            case 1:
+            case 2:
+                P.insert(key, value);
+                R.insert(key, value);
+                break;
+            case 3:
+                assert(P.tryChangeValue(key, value) == R.tryChangeValue(key, value));
+                break;
+            case 4:
+                assert(P.erase(key) == R.erase(key));
+                break;
+            case 5:
+                assert(P.count(key) == R.count(key));
+                break;
+            case 6:
+                if (engine() % 8 == 0) {
+                    P.deleteMin();
+                    R.deleteMin();
+                }
+                break;
+            default:
+                if (engine() % 16 == 0) {
+                    assert(P.empty() == R.empty());
+                    if (!R.empty()) {
+                        assert(P.maxValue() == R.maxValue() && P.maxKey() == R.maxKey());
+                    }
+                }
+        }
+        assert(P.size() == R.size());
+    }
+    P.flush();
+    auto it = R.keyBegin();
+    for (auto p : P.queue().byKey()) {
+        assert(p.first == it.key() && p.second == it.value());
+        ++it;
+    }
+    assert(it == R.keyEnd());
+}
+
+int main() {
+    testBurst();
+    testRandom();
+    std::cout << "ALL OK!" << std::endl;
+}
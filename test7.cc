@@ -0,0 +1,105 @@
+#include <iostream>
+#include <exception>
+#include <atomic>
+#include <cassert>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "parallelqueue.hh"
+
+/*Wartość, której porównanie zgłasza wyjątek po podanej liczbie porównań;
+  licznik jest wspólny dla wątków sortujących */
+struct Fragile {
+    static std::atomic<int> budget;
+    int v;
+
+    Fragile(int x = 0) : v(x) { }
+
+    bool operator<(const Fragile &other) const {
+        if (budget >= 0 && budget.fetch_sub(1) == 0) {
+            throw std::runtime_error("compare");
+        }
+        return v < other.v;
+    }
+
+    bool operator==(const Fragile &other) const {
+        return v == other.v;
+    }
+};
+
+std::atomic<int> Fragile::budget(-1);
+
+void testBuild() {
+    std::mt19937 engine(3);
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < 200000; i++) {
+        pairs.emplace_back(engine() % 100000, engine() % 100000);
+    }
+    PriorityQueue<int, int> sequential(pairs.begin(), pairs.end());
+    PriorityQueue<int, int> parallel(PriorityQueueParallel(4, 1000), pairs.begin(), pairs.end());
+    assert(parallel.size() == pairs.size());
+    assert(parallel == sequential);
+    assert(parallel.minValue() == sequential.minValue() && parallel.maxKey() == sequential.maxKey());
+    int last = -1;
+    for (auto p : parallel.byValue()) {
+        assert(last <= p.second);
+        last = p.second;
+    }
+
+    PriorityQueue<int, int> empty(PriorityQueueParallel(), pairs.end(), pairs.end());
+    assert(empty.empty());
+}
+
+void testMerge() {
+    PriorityQueue<int, int> P, Q, R;
+    for (int i = 0; i < 50000; i++) {
+        P.insert(i, (i * 7919) % 50000);
+        Q.insert(i + 50000, (i * 31) % 50000);
+        R.insert(i, (i * 7919) % 50000);
+        R.insert(i + 50000, (i * 31) % 50000);
+    }
+    P.merge(PriorityQueueParallel(2), Q);
+    assert(Q.empty() && P.size() == 100000);
+    assert(P == R);
+    P.deleteMin();
+    R.deleteMin();
+    assert(P == R);
+}
+
+void testExceptions() {
+    std::vector<std::pair<int, Fragile>> pairs;
+    for (int i = 0; i < 20000; i++) {
+        pairs.emplace_back(i, Fragile((i * 31) % 20000));
+    }
+    for (int budget : {0, 100, 5000, 40000}) {
+        Fragile::budget = budget;
+        try {
+            PriorityQueue<int, Fragile> P(PriorityQueueParallel(4, 500), pairs.begin(), pairs.end());
+            assert(false);
+        }
+        catch (const std::runtime_error &) {
+        }
+    }
+
+    Fragile::budget = -1;
+    PriorityQueue<int, Fragile> P(pairs.begin(), pairs.begin() + 10000);
+    PriorityQueue<int, Fragile> Q(pairs.begin() + 10000, pairs.end());
+    PriorityQueue<int, Fragile> before(P);
+    Fragile::budget = 3000;
+    try {
+        P.merge(PriorityQueueParallel(2), Q);
+        assert(false);
+    }
+    catch (const std::runtime_error &) {
+    }
+    Fragile::budget = -1;
+    assert(P == before && Q.size() == 10000);
+}
+
+int main() {
+    testBuild();
+    testMerge();
+    testExceptions();
+    std::cout << "ALL OK!" << std::endl;
+}
@@ -0,0 +1,112 @@
+#include <iostream>
+#include <exception>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "priorityqueue.hh"
+#include "radixqueue.hh"
+
+void testExample() {
+    RadixPriorityQueue<std::string, int> P;
+    assert(P.empty());
+    P.insert("b", 13);
+    P.insert("a", 42);
+    P.insert("c", -7);
+    assert(P.size() == 3 && P.minValue() == -7 && P.minKey() == "c");
+
+    try {
+        P.insert("d", -8);
+        assert(!"did not throw");
+    }
+    catch (const PriorityQueueMonotoneException &) {
+    }
+    try {
+        P.changeValue("e", 1);
+        assert(!"did not throw");
+    }
+    catch (const PriorityQueueNotFoundException &) {
+    }
+
+    P.changeValue("a", -7);
+    P.deleteMin();
+    P.deleteMin();
+    assert(P.size() == 1 && P.minKey() == "b");
+    try {
+        P.changeValue("b", -8);
+        assert(!"did not throw");
+    }
+    catch (const PriorityQueueMonotoneException &) {
+    }
+    assert(P.minValue() == 13 && P.contains("b") && !P.contains("a"));
+
+    RadixPriorityQueue<std::string, int> Q(P);
+    P.deleteMin();
+    P.deleteMin();
+    assert(P.empty() && Q.count("b") == 1);
+    try {
+        P.minValue();
+        assert(!"did not throw");
+    }
+    catch (const PriorityQueueEmptyException &) {
+    }
+    Q.insert(std::string("x"), 13);
+    P = Q;
+    Q.deleteMin();
+    assert(P.size() == 2 && Q.size() == 1);
+    swap(P, Q);
+    assert(P.size() == 1 && Q.size() == 2 && Q.minValue() == 13);
+}
+
+/*Symulacja kolejki timerów porównywana z PriorityQueue */
+template<typename V>
+void testTimers(V start, int steps) {
+    std::mt19937 engine(5);
+    RadixPriorityQueue<int, V> P;
+    PriorityQueue<int, V> R;
+    V now = start;
+    for (int step = 0; step < steps; step++) {
+        int key = static_cast<int>(engine() % 1000);
+        switch (engine() % 4) {
+        case 0:
+        case 1: {
+            V value = static_cast<V>(now + static_cast<V>(engine() % 5000));
+            P.insert(key, value);
+            R.insert(key, value);
+            break;
+        }
+        case 2:
+            if (R.contains(key)) {
+                V value = static_cast<V>(now + static_cast<V>(engine() % 100));
+                P.changeValue(key, value);
+                R.changeValue(key, value);
+            }
+            break;
+        default:
+            if (!R.empty()) {
+                assert(P.minValue() == R.minValue());
+                now = P.minValue();
+                // przy równych wartościach kolejność par może być inna, więc
+                // z R jest usuwana ta sama para, a nie pierwsza w porządku wartości
+                R.erase(R.keyRange(P.minKey(), P.minKey() + 1).begin().toHandle());
+                P.deleteMin();
+            }
+        }
+        assert(P.size() == R.size());
+    }
+    while (!R.empty()) {
+        assert(P.minValue() == R.minValue());
+        R.erase(R.keyRange(P.minKey(), P.minKey() + 1).begin().toHandle());
+        P.deleteMin();
+    }
+    assert(P.empty());
+}
+
+int main() {
+    testExample();
+    testTimers<std::uint64_t>(0, 200000);
+    testTimers<std::int64_t>(-1000000, 200000);
+    testTimers<unsigned short>(0, 5000);
+    std::cout << "ALL OK!" << std::endl;
+}
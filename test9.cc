@@ -0,0 +1,187 @@
+#include <iostream>
+#include <exception>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "asyncqueue.hh"
+
+using Queue = AsyncPriorityQueue<int, int, 8>;
+
+void waitForWaiters(Queue &P, std::size_t n) {
+    while (P.waiters() != n) {
+        std::this_thread::yield();
+    }
+}
+
+void testSequential() {
+    Queue P;
+    assert(P.empty() && P.waiters() == 0);
+    assert(!P.waitPopMin(std::chrono::milliseconds(10)));
+    assert(P.waiters() == 0);
+
+    P.insert(1, 30);
+    P.insert(2, 10);
+    P.insert(3, 20);
+    assert(P.waitPopMin() == std::make_pair(2, 10));
+    auto p = P.waitPopMin(std::chrono::seconds(1));
+    assert(p && *p == std::make_pair(3, 20));
+    P.changeValue(1, 5);
+    assert(P.tryDeleteMin()->second == 5);
+    assert(P.empty() && !P.tryDeleteMin());
+}
+
+/*Wstawienie n par budzi dokładnie n czekających, a każdy dostaje inną parę */
+void testHandoff() {
+    const int consumers = 64;
+    Queue P;
+    std::vector<int> got(consumers, -1);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < consumers; t++) {
+        workers.emplace_back([&P, &got, t]() {
+            got[t] = P.waitPopMin().first;
+        });
+    }
+    waitForWaiters(P, consumers);
+
+    std::vector<std::pair<int, int>> batch;
+    for (int i = 0; i < 10; i++) {
+        batch.emplace_back(i, i);
+    }
+    P.insert(batch.begin(), batch.end());
+    assert(P.empty() && P.waiters() == consumers - 10);
+
+    for (int i = 10; i < consumers; i++) {
+        P.insert(i, i);
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    assert(P.waiters() == 0 && P.empty());
+    std::vector<bool> seen(consumers, false);
+    for (int key : got) {
+        assert(key >= 0 && key < consumers && !seen[key]);
+        seen[key] = true;
+    }
+}
+
+/*Producenci i konsumenci z limitem czasu: każda para jest zdjęta dokładnie raz */
+void testPipeline(bool relaxed) {
+    const int producers = 4;
+    const int consumers = 8;
+    const int perProducer = 5000;
+    Queue P(relaxed);
+    std::atomic<int> remaining(producers * perProducer);
+    std::vector<std::vector<int>> taken(consumers);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < consumers; t++) {
+        workers.emplace_back([&P, &remaining, &taken, t]() {
+            while (remaining.load() > 0) {
+                if (auto p = P.waitPopMin(std::chrono::milliseconds(1))) {
+                    taken[t].push_back(p->first);
+                    remaining.fetch_sub(1);
+                }
+            }
+        });
+    }
+    for (int t = 0; t < producers; t++) {
+        workers.emplace_back([&P, t]() {
+            for (int i = 0; i < perProducer; i++) {
+                P.insert(t * perProducer + i, i);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    assert(P.empty() && P.waiters() == 0);
+
+    std::vector<bool> seen(producers * perProducer, false);
+    for (auto &keys : taken) {
+        for (int key : keys) {
+            assert(!seen[key]);
+            seen[key] = true;
+        }
+    }
+    for (bool s : seen) {
+        assert(s);
+    }
+}
+
+#ifdef ASYNCQUEUE_COROUTINES
+/*Korutyna uruchamiana od razu i niszcząca się sama po zakończeniu */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept {
+            return Detached();
+        }
+
+        std::suspend_never initial_suspend() noexcept {
+            return std::suspend_never();
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return std::suspend_never();
+        }
+
+        void return_void() noexcept {
+        }
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+};
+
+Detached consume(Queue &P, std::vector<int> &got, int index) {
+    got[index] = (co_await P.popMin()).first;
+}
+
+void testCoroutines() {
+    const int consumers = 2000;
+    Queue P;
+    std::vector<int> got(consumers, -1);
+    P.insert(7, 7);
+    consume(P, got, 0);
+    assert(got[0] == 7 && P.waiters() == 0);
+
+    for (int i = 1; i < consumers; i++) {
+        consume(P, got, i);
+    }
+    assert(P.waiters() == consumers - 1);
+    P.insert(3, 1);
+    assert(got[1] == 3 && got[2] == -1);
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; t++) {
+        producers.emplace_back([&P, t]() {
+            for (int i = 0; i < 500; i++) {
+                P.insert(10 + t * 500 + i, i);
+            }
+        });
+    }
+    for (auto &p : producers) {
+        p.join();
+    }
+    assert(P.waiters() == 0 && P.size() == 2);
+    std::vector<bool> seen(consumers + 10, false);
+    for (int i = 2; i < consumers; i++) {
+        assert(got[i] >= 10 && !seen[got[i]]);
+        seen[got[i]] = true;
+    }
+}
+#endif
+
+int main() {
+    testSequential();
+    testHandoff();
+    testPipeline(false);
+    testPipeline(true);
+#ifdef ASYNCQUEUE_COROUTINES
+    testCoroutines();
+#endif
+    std::cout << "ALL OK!" << std::endl;
+}